@@ -0,0 +1,53 @@
+FIND_PATH(LUA_INCLUDE_DIR luajit.h
+  PATH_SUFFIXES include/ luajit/ luajit/include/ ./ luajit-2.1/ include/luajit-2.1/ luajit-2.0/ include/luajit-2.0/ src/ luajit/src/
+  PATHS "${PROJECT_SOURCE_DIR}/../luajit/"
+  "${PROJECT_SOURCE_DIR}/extlibs/luajit/"
+  ${LUAJIT_ROOT}
+  $ENV{LUAJIT_ROOT}
+  /usr/local/
+  /usr/
+  /sw/
+  /opt/local/
+  /opt/csw/
+  /opt/
+)
+
+message("\nFound LuaJIT include at: ${LUA_INCLUDE_DIR}.\n")
+
+FIND_LIBRARY(LUA_LIBRARY
+  NAMES luajit-5.1 libluajit-5.1 luajit libluajit lua51
+  PATH_SUFFIXES lib/ lib/x86_64-linux-gnu/ lib64/ luajit/ luajit/lib/ luajit/lib64/ src/ luajit/src/ ./
+  PATHS "${PROJECT_SOURCE_DIR}/../luajit/"
+  "${PROJECT_SOURCE_DIR}/extlibs/luajit/"
+  ${LUAJIT_ROOT}
+  $ENV{LUAJIT_ROOT}
+  /usr/local/
+  /usr/
+  /sw/
+  /opt/local/
+  /opt/csw/
+  /opt/
+  /usr/lib/x86_64-linux-gnu
+)
+
+message("\nFound LuaJIT library at: ${LUA_LIBRARY}.\n")
+
+IF(LUA_LIBRARY AND LUA_INCLUDE_DIR)
+  SET(LUA_LIBRARIES ${LUA_LIBRARY})
+  SET(LUAJIT_FOUND TRUE)
+ELSE(LUA_LIBRARY AND LUA_INCLUDE_DIR)
+  SET(LUAJIT_FOUND FALSE)
+ENDIF(LUA_LIBRARY AND LUA_INCLUDE_DIR)
+
+IF(LUAJIT_FOUND)
+  MESSAGE(STATUS "Found LuaJIT in ${LUA_INCLUDE_DIR}")
+ELSE(LUAJIT_FOUND)
+  IF(LuaJIT_FIND_REQUIRED)
+  MESSAGE(FATAL_ERROR "Could not find LuaJIT library")
+  ENDIF(LuaJIT_FIND_REQUIRED)
+ENDIF(LUAJIT_FOUND)
+
+MARK_AS_ADVANCED(
+  LUA_LIBRARY
+  LUA_INCLUDE_DIR
+)
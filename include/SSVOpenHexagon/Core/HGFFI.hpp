@@ -0,0 +1,25 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_FFI
+#define HG_FFI
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    class HexagonGame;
+
+#ifdef HG_USE_LUAJIT
+    // Makes `mGame` the target of the exported `hg_*` C entry points and
+    // rebinds the hottest Lua API functions (`w_wall*`, `l_get*`,
+    // `u_get*Mult*`) to them through LuaJIT's FFI, bypassing the
+    // `LuaContext` marshalling layer. Must run after the regular bindings.
+    void initFFI(Lua::LuaContext& mLua, HexagonGame& mGame);
+#else
+    inline void initFFI(Lua::LuaContext&, HexagonGame&) {}
+#endif
+}
+
+#endif
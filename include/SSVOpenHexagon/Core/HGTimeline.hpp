@@ -0,0 +1,214 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_TIMELINE
+#define HG_TIMELINE
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Parameters of a deferred wall spawn. Speeds are stored unscaled: the
+    // difficulty speed multiplier is applied when the action is executed.
+    struct HGWallAction
+    {
+        int side;
+        float thickness, hueMod;
+        float speedAdj, speedAcc, speedMin, speedMax;
+        float curveAdj, curveAcc, curveMin, curveMax;
+        bool speedPingPong, curvePingPong, scaleSpeedBounds;
+    };
+
+    struct HGMessageAction
+    {
+        SizeT idx;
+        float duration;
+    };
+
+    struct HGAction
+    {
+        enum class Type : std::uint8_t
+        {
+            Wait,
+            WaitUntil,
+            Wall,
+            Message,
+            MessageImportant,
+            ShowMessage,
+            ClearMessage,
+            StopTime,
+            Kill
+        };
+
+        Type type;
+        union
+        {
+            FT value;
+            HGWallAction wall;
+            HGMessageAction message;
+        };
+    };
+
+    inline HGWallAction mkWallAction(int mSide, float mThickness,
+        float mSpeedAdj = 1.f, float mHueMod = 0.f)
+    {
+        HGWallAction result;
+        result.side = mSide;
+        result.thickness = mThickness;
+        result.hueMod = mHueMod;
+        result.speedAdj = mSpeedAdj;
+        result.speedAcc = result.speedMin = result.speedMax = 0.f;
+        result.curveAdj = result.curveAcc = result.curveMin =
+            result.curveMax = 0.f;
+        result.speedPingPong = result.curvePingPong =
+            result.scaleSpeedBounds = false;
+        return result;
+    }
+    inline HGWallAction mkWallSpeedAction(int mSide, float mThickness,
+        float mSpeedAdj, float mSpeedAcc, float mSpeedMin, float mSpeedMax,
+        float mHueMod = 0.f)
+    {
+        auto result(mkWallAction(mSide, mThickness, mSpeedAdj, mHueMod));
+        result.speedAcc = mSpeedAcc;
+        result.speedMin = mSpeedMin;
+        result.speedMax = mSpeedMax;
+        return result;
+    }
+    inline HGWallAction mkWallCurveAction(int mSide, float mThickness,
+        float mCurveAdj, float mCurveAcc, float mCurveMin, float mCurveMax,
+        float mHueMod = 0.f)
+    {
+        auto result(mkWallAction(mSide, mThickness, 1.f, mHueMod));
+        result.curveAdj = mCurveAdj;
+        result.curveAcc = mCurveAcc;
+        result.curveMin = mCurveMin;
+        result.curveMax = mCurveMax;
+        return result;
+    }
+
+    // Compact replacement for `ssvu::Timeline` used by level scripts.
+    // Actions are stored by value in a vector that is reused between steps,
+    // and message strings are kept in a pool of reused slots, so clearing
+    // and refilling the timeline does not allocate once capacity is reached.
+    class HGTimeline
+    {
+    private:
+        std::vector<HGAction> actions;
+        std::vector<std::string> strings;
+        SizeT stringCount{0}, current{0};
+        FT waitRemaining{0}, remainder{0};
+        bool waiting{false};
+
+        inline HGAction& appendImpl(HGAction::Type mType)
+        {
+            actions.emplace_back();
+            auto& result(actions.back());
+            result.type = mType;
+            return result;
+        }
+        inline SizeT storeString(const std::string& mStr)
+        {
+            if(stringCount == strings.size())
+                strings.emplace_back(mStr);
+            else
+                strings[stringCount] = mStr;
+
+            return stringCount++;
+        }
+
+    public:
+        inline void clear()
+        {
+            actions.clear();
+            stringCount = 0;
+            reset();
+        }
+        inline void reset()
+        {
+            current = 0;
+            waitRemaining = remainder = 0;
+            waiting = false;
+        }
+
+        inline bool isFinished() const noexcept
+        {
+            return current >= actions.size();
+        }
+        inline const std::string& getString(SizeT mIdx) const
+        {
+            return strings[mIdx];
+        }
+
+        inline void appendWait(FT mDuration)
+        {
+            appendImpl(HGAction::Type::Wait).value = mDuration;
+        }
+        inline void appendWaitUntil(float mSeconds)
+        {
+            appendImpl(HGAction::Type::WaitUntil).value = mSeconds;
+        }
+        inline void appendStopTime(FT mDuration)
+        {
+            appendImpl(HGAction::Type::StopTime).value = mDuration;
+        }
+        inline void appendKill() { appendImpl(HGAction::Type::Kill); }
+        inline void appendWall(const HGWallAction& mWall)
+        {
+            appendImpl(HGAction::Type::Wall).wall = mWall;
+        }
+        inline void appendMessage(HGAction::Type mType, const std::string& mMsg,
+            float mDuration = 0.f)
+        {
+            auto idx(storeString(mMsg));
+            auto& message(appendImpl(mType).message);
+            message.idx = idx;
+            message.duration = mDuration;
+        }
+        inline void appendClearMessage()
+        {
+            appendImpl(HGAction::Type::ClearMessage);
+        }
+
+        // Runs actions until a wait is hit. `mExec` is called for every
+        // non-wait action; for `WaitUntil` its return value tells whether the
+        // condition is satisfied, otherwise it is ignored.
+        // Like `ssvu::Timeline`, an expiring wait ends the current update.
+        template <typename TF>
+        inline void update(FT mFT, TF&& mExec)
+        {
+            while(current < actions.size())
+            {
+                const auto a(actions[current]);
+
+                if(a.type != HGAction::Type::Wait &&
+                    a.type != HGAction::Type::WaitUntil)
+                {
+                    mExec(a);
+                    ++current;
+                    continue;
+                }
+
+                if(!waiting)
+                {
+                    waiting = true;
+                    waitRemaining =
+                        (a.type == HGAction::Type::Wait ? a.value : 10) +
+                        remainder;
+                    remainder = 0;
+                }
+
+                waitRemaining -= mFT;
+                if(waitRemaining > 0) return;
+
+                remainder = waitRemaining;
+                waiting = false;
+
+                if(a.type == HGAction::Type::Wait || mExec(a)) ++current;
+                return;
+            }
+        }
+    };
+}
+
+#endif
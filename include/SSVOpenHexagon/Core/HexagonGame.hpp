@@ -7,6 +7,7 @@
 
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Core/HGStatus.hpp"
+#include "SSVOpenHexagon/Core/HGTimeline.hpp"
 #include "SSVOpenHexagon/Data/LevelData.hpp"
 #include "SSVOpenHexagon/Data/MusicData.hpp"
 #include "SSVOpenHexagon/Data/StyleData.hpp"
@@ -15,18 +16,22 @@
 #include "SSVOpenHexagon/Global/Factory.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 #include "SSVOpenHexagon/Utils/FPSWatcher.hpp"
+#include "SSVOpenHexagon/Utils/FileWatcher.hpp"
+#include "SSVOpenHexagon/Utils/LuaGC.hpp"
 
 namespace hg
 {
     class MenuGame;
+    struct HGFFIBridge;
 
     class HexagonGame
     {
         friend MenuGame;
+        friend HGFFIBridge;
 
     private:
         HGAssets& assets;
-        const LevelData* levelData;
+        const LevelData* levelData{nullptr};
 
         ssvs::GameState game;
         ssvs::GameWindow& window;
@@ -41,13 +46,24 @@ namespace hg
         ssvu::TimelineManager effectTimelineManager;
         Factory factory{*this, manager, ssvs::zeroVec2f};
         Lua::LuaContext lua;
+        LuaGC luaGC;
+        std::unordered_map<std::string, float> luaPeakKBs;
+        const float luaGCStepKB{16.f}, luaGCTimeStopStepKB{256.f};
         LevelStatus levelStatus;
-        MusicData musicData;
+        const MusicData* musicData{nullptr};
         StyleData styleData;
-        ssvu::Timeline timeline, eventTimeline, messageTimeline;
+        HGTimeline timeline, eventTimeline, messageTimeline;
         sf::Text messageText{"", assets.get<sf::Font>("imagine.ttf"),
             ssvu::toNum<unsigned int>(38.f / Config::getZoomFactor())};
         ssvs::VertexVector<sf::PrimitiveType::Quads> flashPolygon{4};
+        const HGAssets::SoundHandle
+            beepSound{assets.getSoundHandle("beep.ogg")},
+            deathSound{assets.getSoundHandle("death.ogg")},
+            gameOverSound{assets.getSoundHandle("gameOver.ogg")},
+            levelUpSound{assets.getSoundHandle("levelUp.ogg")},
+            goSound{assets.getSoundHandle("go.ogg")},
+            swapSound{assets.getSoundHandle("swap.ogg")};
+        bool musicFirstPlay{true};
         bool firstPlay{true}, restartFirstTime{true}, inputFocused{false},
             inputSwap{false}, mustTakeScreenshot{false}, mustChangeSides{false};
         HexagonGameStatus status;
@@ -58,6 +74,8 @@ namespace hg
         std::ostringstream os;
 
         FPSWatcher fpsWatcher;
+        // Only opened by `initHotReload`.
+        UPtr<FileWatcher> fileWatcher;
         sf::Text text{"", assets.get<sf::Font>("imagine.ttf"),
             ssvu::toNum<unsigned int>(25.f / Config::getZoomFactor())};
 
@@ -67,6 +85,7 @@ namespace hg
 
         // LUA-related methods
         void initLua();
+        void reportLuaMemory();
         inline void runLuaFile(const std::string& mFileName)
         {
             try
@@ -107,6 +126,7 @@ namespace hg
         void updateFlash(FT mFT);
         void update3D(FT mFT);
         void updateText();
+        void updateHotReload();
 
         // Draw methods
         void draw();
@@ -126,11 +146,21 @@ namespace hg
         // Message-related methods
         void addMessage(const std::string& mMessage, float mDuration);
 
+        // Timeline-related methods
+        bool runTimelineAction(
+            const HGTimeline& mTimeline, const HGAction& mAction);
+        void spawnWall(const HGWallAction& mWall);
+
         // Level/menu loading/unloading/changing
         void checkAndSaveScore();
         void goToMenu(bool mSendScores = true);
         void changeLevel(const std::string& mId, bool mFirstTime);
 
+        // Hot reload
+        void initHotReload();
+        void hotReloadScript(const Path& mPath);
+        void hotReloadLevel(const Path& mPath);
+
         void invalidateScore();
 
     public:
@@ -148,6 +178,7 @@ namespace hg
 
         // Other methods
         void executeEvents(ssvuj::Obj& mRoot, float mTime);
+        inline void playSwapSound() { assets.playSound(swapSound); }
 
         // Graphics-related methods
         inline void render(sf::Drawable& mDrawable) { window.draw(mDrawable); }
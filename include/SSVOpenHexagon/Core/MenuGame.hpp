@@ -35,6 +35,8 @@ namespace hg
         HGAssets& assets;
         sf::Font& imagine = assets.get<sf::Font>(
             "imagine.ttf"); // G++ bug (cannot initialize with curly braces)
+        const HGAssets::SoundHandle beepSound{
+            assets.getSoundHandle("beep.ogg")};
 
         float wheelProgress{0.f};
 
@@ -154,7 +156,6 @@ namespace hg
         void setIndex(int mIdx);
         void updateLeaderboard();
         void updateFriends();
-        void initLua(Lua::LuaContext& mLua);
 
         inline bool isEnteringText()
         {
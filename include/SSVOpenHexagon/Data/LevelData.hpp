@@ -35,6 +35,9 @@ namespace hg
         std::vector<float> difficultyMults{
             ssvuj::getExtr<std::vector<float>>(root, "difficultyMults", {})};
 
+        // Interned `styleId` and `musicId`, set by `HGAssets::resolveHandles`.
+        SizeT styleHandle{0}, musicHandle{0};
+
         LevelData(const ssvuj::Obj& mRoot, const Path& mPackPath)
             : root{mRoot}, packPath{mPackPath}
         {
@@ -0,0 +1,29 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_LEVELPREVIEW
+#define HG_LEVELPREVIEW
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Data/LevelData.hpp"
+#include "SSVOpenHexagon/Data/StyleData.hpp"
+
+namespace hg
+{
+    // Values the menu needs to preview a level, obtained by running the
+    // level's `onInit` and `onLoad` once against a stubbed Lua API.
+    struct LevelPreview
+    {
+        float rotationSpeed{0.f}, hueIncrement{0.f}, pulseIncrement{0.f};
+        unsigned int sides{6};
+        std::string error;
+    };
+
+    // Thread-safe: only reads `mLevelData` and `mStyleData`, and reports
+    // Lua errors through `LevelPreview::error` instead of logging them.
+    LevelPreview computeLevelPreview(
+        const LevelData& mLevelData, const StyleData& mStyleData);
+}
+
+#endif
@@ -25,7 +25,6 @@ namespace hg
 
     public:
         std::string id, fileName, name, album, author;
-        bool firstPlay{true};
 
         MusicData() = default;
         MusicData(const std::string& mId, const std::string& mFileName,
@@ -40,21 +39,23 @@ namespace hg
         {
             segments.emplace_back(mSeconds);
         }
-        inline void playRandomSegment(HGAssets& mAssets)
+        // Plays the first segment if `mFirstPlay` is set (and clears it),
+        // otherwise a random one.
+        inline void playRandomSegment(HGAssets& mAssets, bool& mFirstPlay) const
         {
-            if(firstPlay)
+            if(mFirstPlay)
             {
-                firstPlay = false;
+                mFirstPlay = false;
                 playSegment(mAssets, 0);
             }
             else
                 playSeconds(mAssets, getRandomSegment());
         }
-        inline void playSegment(HGAssets& mAssets, SizeT mIdx)
+        inline void playSegment(HGAssets& mAssets, SizeT mIdx) const
         {
             playSeconds(mAssets, segments[mIdx]);
         }
-        inline void playSeconds(HGAssets& mAssets, float mSeconds)
+        inline void playSeconds(HGAssets& mAssets, float mSeconds) const
         {
             if(Config::getNoMusic()) return;
             mAssets.playMusic(id, sf::seconds(mSeconds));
@@ -5,6 +5,7 @@
 #ifndef HG_STYLEDATA
 #define HG_STYLEDATA
 
+#include <memory>
 #include "SSVOpenHexagon/Global/Common.hpp"
 
 namespace hg
@@ -36,29 +37,35 @@ namespace hg
             }
         };
 
+        // Parsed once per style file and shared, immutable, by every copy:
+        // copying a style only copies its runtime state.
+        struct Definition
+        {
+            std::string id;
+            Path rootPath;
+            ColorData mainColorData;
+            std::vector<ColorData> colorDatas;
+        };
+
+        std::shared_ptr<const Definition> definition;
         float currentHue, currentSwapTime{0}, pulseFactor{0};
-        Path rootPath;
         sf::Color currentMainColor, current3DOverrideColor;
         std::vector<sf::Color> currentColors;
 
         sf::Color calculateColor(const ColorData& mColorData) const;
 
     public:
-        std::string id;
         float hueMin, hueMax, hueIncrement, pulseMin, pulseMax, pulseIncrement;
         bool huePingPong;
         float maxSwapTime, _3dDepth, _3dSkew, _3dSpacing, _3dDarkenMult,
             _3dAlphaMult, _3dAlphaFalloff, _3dPulseMax, _3dPulseMin,
             _3dPulseSpeed, _3dPerspectiveMult;
         sf::Color _3dOverrideColor;
-        ColorData mainColorData;
-        std::vector<ColorData> colorDatas;
 
-        StyleData() = default;
+        // Empty, with no id or colors, until a style is assigned.
+        StyleData() : definition{std::make_shared<const Definition>()} {}
         StyleData(const ssvuj::Obj& mRoot, const Path& mPath)
-            : rootPath{mPath},
-              id{ssvuj::getExtr<std::string>(mRoot, "id", "nullId")},
-              hueMin{ssvuj::getExtr<float>(mRoot, "hue_min", 0.f)},
+            : hueMin{ssvuj::getExtr<float>(mRoot, "hue_min", 0.f)},
               hueMax{ssvuj::getExtr<float>(mRoot, "hue_max", 360.f)},
               hueIncrement{ssvuj::getExtr<float>(mRoot, "hue_increment", 0.f)},
               pulseMin{ssvuj::getExtr<float>(mRoot, "pulse_min", 0.f)},
@@ -83,16 +90,22 @@ namespace hg
               _3dPerspectiveMult{ssvuj::getExtr<float>(
                   mRoot, "3D_perspective_multiplier", 1.f)},
               _3dOverrideColor{ssvuj::getExtr<sf::Color>(
-                  mRoot, "3D_override_color", sf::Color::Transparent)},
-              mainColorData{ssvuj::getObj(mRoot, "main")}
+                  mRoot, "3D_override_color", sf::Color::Transparent)}
         {
             currentHue = hueMin;
 
+            auto def(std::make_shared<Definition>());
+            def->id = ssvuj::getExtr<std::string>(mRoot, "id", "nullId");
+            def->rootPath = mPath;
+            def->mainColorData = ColorData{ssvuj::getObj(mRoot, "main")};
+
             const auto& objColors(ssvuj::getObj(mRoot, "colors"));
             const auto& colorCount(ssvuj::getObjSize(objColors));
 
             for(auto i(0u); i < colorCount; i++)
-                colorDatas.emplace_back(ssvuj::getObj(objColors, i));
+                def->colorDatas.emplace_back(ssvuj::getObj(objColors, i));
+
+            definition = std::move(def);
         }
 
         void update(FT mFT, float mMult = 1.f);
@@ -100,9 +113,11 @@ namespace hg
         void drawBackground(sf::RenderTarget& mRenderTarget,
             const Vec2f& mCenterPos, unsigned int mSides);
 
-        void setRootPath(const Path& mPath) { rootPath = mPath; }
-
-        inline const Path& getRootPath() const { return rootPath; }
+        inline const std::string& getId() const { return definition->id; }
+        inline const Path& getRootPath() const
+        {
+            return definition->rootPath;
+        }
 
         inline const sf::Color& getMainColor() const
         {
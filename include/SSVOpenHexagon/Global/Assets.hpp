@@ -5,13 +5,17 @@
 #ifndef HG_ASSETS
 #define HG_ASSETS
 
+#include <future>
+#include <mutex>
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Data/LevelData.hpp"
+#include "SSVOpenHexagon/Data/LevelPreview.hpp"
 #include "SSVOpenHexagon/Data/PackData.hpp"
 #include "SSVOpenHexagon/Data/ProfileData.hpp"
 #include "SSVOpenHexagon/Data/StyleData.hpp"
 #include "SSVOpenHexagon/Online/Online.hpp"
 #include "SSVOpenHexagon/Online/OHServer.hpp"
+#include "SSVOpenHexagon/Utils/SoundPool.hpp"
 
 namespace hg
 {
@@ -19,13 +23,22 @@ namespace hg
 
     class HGAssets
     {
+    public:
+        // Sound buffers are looked up once and played through their handle.
+        // Styles and music are interned: their ids are resolved to indices
+        // once, when levels are loaded (`LevelData::styleHandle` and
+        // `LevelData::musicHandle`).
+        using SoundHandle = sf::SoundBuffer*;
+        using StyleHandle = SizeT;
+        using MusicHandle = SizeT;
+
     private:
         bool playingLocally{true};
 
         bool levelsOnly{false};
 
         ssvs::AssetManager<> assetManager;
-        ssvs::SoundPlayer soundPlayer;
+        SoundPool soundPool{16};
 
     public:
         ssvs::MusicPlayer musicPlayer;
@@ -34,13 +47,42 @@ namespace hg
         std::unordered_map<std::string, UPtr<LevelData>> levelDatas;
         std::unordered_map<std::string, std::vector<std::string>>
             levelDataIdsByPack;
+        std::unordered_map<std::string, LevelPreview> levelPreviews;
+
+        // Thread-safe. Reports an unknown style or any other failure
+        // through `LevelPreview::error`, leaving the default preview.
+        LevelPreview tryComputeLevelPreview(const LevelData& mLevelData);
 
         std::unordered_map<std::string, UPtr<PackData>> packDatas;
         std::vector<std::string> packIds;
         std::vector<Path> packPaths;
 
-        std::map<std::string, MusicData> musicDataMap;
-        std::map<std::string, StyleData> styleDataMap;
+        // Pack music is opened on demand and kept in `openMusics`, most
+        // recently used first. Prefetch threads only ever add tracks to it;
+        // tracks are closed on the main thread by `trimOpenMusics`, which
+        // never closes `playingMusic`.
+        std::unordered_map<std::string, Path> musicPaths;
+        std::vector<std::pair<std::string, UPtr<sf::Music>>> openMusics;
+        sf::Music* playingMusic{nullptr};
+        std::mutex musicMutex;
+        const SizeT maxOpenMusics{3};
+        // Each prefetch yields the id of its track if it failed to open.
+        std::vector<std::future<std::string>> musicPrefetches;
+
+        // Thread-safe. Returns `nullptr`, without logging, if the track
+        // is unknown or cannot be opened.
+        sf::Music* getMusic(const std::string& mId);
+        void trimOpenMusics();
+
+        // Forgets finished prefetches, logging the tracks they failed to
+        // open.
+        void collectMusicPrefetches();
+        void logMusicError(const std::string& mId);
+
+        std::vector<MusicData> musicDatas;
+        std::vector<StyleData> styleDatas;
+        std::unordered_map<std::string, MusicHandle> musicHandles;
+        std::unordered_map<std::string, StyleHandle> styleHandles;
         std::map<std::string, ProfileData> profileDataMap;
         ProfileData* currentProfilePtr{nullptr};
 
@@ -65,6 +107,10 @@ namespace hg
         {
             return *levelDatas.at(mId);
         }
+        inline const LevelPreview& getLevelPreview(const std::string& mId)
+        {
+            return levelPreviews.at(mId);
+        }
         inline const std::vector<std::string>& getLevelIdsByPack(
             const Path& mPackPath)
         {
@@ -82,17 +128,41 @@ namespace hg
 
         void loadAssets();
 
-        void loadMusic(const Path& mPath);
-        void loadMusicData(const Path& mPath);
-        void loadStyleData(const Path& mPath);
-        void loadLevelData(const Path& mPath);
-        void loadCustomSounds(const std::string& mPackName, const Path& mPath);
+        void loadMusic(const std::vector<Path>& mFiles);
+        void loadCustomSounds(
+            const std::string& mPackName, const std::vector<Path>& mFiles);
         void loadLocalProfiles();
+        void loadLevelPreviews();
+
+        // Hot reload support
+        const LevelData* reloadLevelData(const Path& mPath);
+        std::vector<std::string> getLevelIdsUsingScript(
+            const Path& mScriptPath);
+        void refreshLevelPreview(const std::string& mId);
+
+        // Resolves the style and music handles of `mLevelData`.
+        void resolveHandles(LevelData& mLevelData);
 
         void saveCurrentLocalProfile();
 
-        const MusicData& getMusicData(const std::string& mId);
-        const StyleData& getStyleData(const std::string& mId);
+        inline MusicHandle getMusicHandle(const std::string& mId)
+        {
+            return musicHandles.at(mId);
+        }
+        inline StyleHandle getStyleHandle(const std::string& mId)
+        {
+            return styleHandles.at(mId);
+        }
+        const MusicData& getMusicData(MusicHandle mHandle);
+        const StyleData& getStyleData(StyleHandle mHandle);
+        inline const MusicData& getMusicData(const std::string& mId)
+        {
+            return getMusicData(getMusicHandle(mId));
+        }
+        inline const StyleData& getStyleData(const std::string& mId)
+        {
+            return getStyleData(getStyleHandle(mId));
+        }
 
 
         float getLocalScore(const std::string& mId);
@@ -164,11 +234,20 @@ namespace hg
         void refreshVolumes();
         void stopMusics();
         void stopSounds();
-        void playSound(const std::string& mId,
-            ssvs::SoundPlayer::Mode mMode = ssvs::SoundPlayer::Mode::Override);
+        // Returns `nullptr` if there is no sound named `mId`.
+        SoundHandle getSoundHandle(const std::string& mId);
+        void playSound(SoundHandle mHandle,
+            SoundPool::Mode mMode = SoundPool::Mode::Override,
+            SoundPool::Priority mPriority = SoundPool::Priority::Normal);
+        inline void playSound(const std::string& mId,
+            SoundPool::Mode mMode = SoundPool::Mode::Override,
+            SoundPool::Priority mPriority = SoundPool::Priority::Normal)
+        {
+            playSound(getSoundHandle(mId), mMode, mPriority);
+        }
         void playMusic(
             const std::string& mId, sf::Time mPlayingOffset = sf::seconds(0));
-        inline ssvs::SoundPlayer& getSoundPlayer() { return soundPlayer; }
+        void prefetchMusic(const std::string& mId);
         inline ssvs::MusicPlayer& getMusicPlayer() { return musicPlayer; }
     };
 }
@@ -53,6 +53,7 @@ namespace hg
         void setMusicSpeedMult(float mValue);
         void setDrawTextOutlines(bool mX);
         void setRotateToStart(bool mX);
+        void setHotReload(bool mX);
 
         bool getOnline();
         bool getOfficial();
@@ -105,9 +106,11 @@ namespace hg
         unsigned int getAntialiasingLevel();
         bool getServerLocal();
         bool getServerVerbose();
+        std::string getServerStorage();
         bool getMouseVisible();
         float getMusicSpeedMult();
         bool getDrawTextOutlines();
+        bool getHotReload();
 
         ssvs::Input::Trigger getTriggerRotateCCW();
         ssvs::Input::Trigger getTriggerRotateCW();
@@ -5,58 +5,73 @@
 #ifndef HG_ONLINE_CLIENTHANDLER
 #define HG_ONLINE_CLIENTHANDLER
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Global/Config.hpp"
 #include "SSVOpenHexagon/Online/Utils.hpp"
-#include "SSVOpenHexagon/Online/ManagedSocket.hpp"
-#include "SSVOpenHexagon/Online/PacketHandler.hpp"
 
 namespace hg
 {
     namespace Online
     {
-        class Server;
-
-        class ClientHandler : public ManagedSocket
+        // A connection accepted by `Server`. Its socket is non-blocking and
+        // is read and closed by the I/O thread that accepted it, while its
+        // packets are handled by a worker thread, which may send replies.
+        class ClientHandler
         {
         private:
-            static unsigned int lastUid;
-            bool running{true};
-            unsigned int uid{lastUid++}, untilTimeout{5};
-            PacketHandler<ClientHandler> packetHandler;
-            std::future<void> timeoutFuture;
+            static std::atomic<unsigned int> lastUid;
+            static constexpr std::chrono::seconds timeout{4};
+
+            sf::TcpSocket socket;
+            std::mutex sendMutex;
+            std::deque<sf::Packet> outgoing;
+            std::chrono::steady_clock::time_point lastActivity;
+            unsigned int uid{0};
+            std::atomic<bool> busy{false};
+
+            void flushImpl();
 
         public:
+            // Called on the client's worker thread after its last packet.
             ssvu::Delegate<void()> onDisconnect;
 
-            inline ClientHandler(PacketHandler<ClientHandler>& mPacketHandler)
-                : packetHandler(mPacketHandler)
-            {
-                onPacketReceived += [this](sf::Packet mPacket)
-                {
-                    packetHandler.handle(*this, mPacket);
-                    refreshTimeout();
-                };
-                timeoutFuture = std::async(std::launch::async, [this]
-                    {
-                        while(running)
-                        {
-                            std::this_thread::sleep_for(800ms);
+            inline ClientHandler() { socket.setBlocking(false); }
+
+            bool tryAccept(sf::TcpListener& mListener);
+
+            // Appends every packet that arrived since the last call.
+            void receive(std::vector<sf::Packet>& mPackets);
 
-                            if(!isBusy() || --untilTimeout > 0) continue;
+            // Sends as much of the queued packets as the socket accepts
+            // without blocking.
+            void flush();
 
-                            HG_LO_VERBOSE("ClientHandler") << "Client (" << uid
-                                                           << ") timed out\n";
-                            onDisconnect();
-                            disconnect();
-                        }
-                    });
+            // Queues `mPacket` and tries to send it right away.
+            bool send(const sf::Packet& mPacket);
+
+            // Marks the client as disconnected; its I/O thread then closes
+            // the socket. Returns false if it already was.
+            bool disconnect();
+            void close();
+
+            inline bool isBusy() const { return busy; }
+            bool hasPendingOutput();
+            inline bool hasTimedOut(
+                std::chrono::steady_clock::time_point mNow) const
+            {
+                return mNow - lastActivity > timeout;
             }
-            inline ~ClientHandler() { running = false; }
 
-            inline void stop() { running = false; }
+            inline sf::TcpSocket& getSocket() { return socket; }
             inline unsigned int getUid() const { return uid; }
-            inline void refreshTimeout() { untilTimeout = 5; }
+            inline void refreshTimeout()
+            {
+                lastActivity = std::chrono::steady_clock::now();
+            }
         };
     }
 }
@@ -7,14 +7,26 @@
 #ifndef HG_ONLINE_COMPRESSION
 #define HG_ONLINE_COMPRESSION
 
-#include <string>
+#include <cstddef>
 #include <zlib.h>
 
 namespace hg
 {
-    std::string getZLibCompress(
-        const std::string& mStr, int mCompressionlevel = Z_BEST_COMPRESSION);
-    std::string getZLibDecompress(const std::string& mStr);
+    // Each thread reuses its own zlib streams, so these are thread-safe.
+
+    // Largest size `mSize` bytes can take once compressed.
+    std::size_t getZLibCompressBound(
+        std::size_t mSize, int mCompressionlevel = Z_BEST_COMPRESSION);
+
+    // Compresses into `mOut`, which must hold `getZLibCompressBound(mSize)`
+    // bytes. Returns the compressed size.
+    std::size_t zlibCompress(const char* mData, std::size_t mSize,
+        char* mOut, int mCompressionlevel = Z_BEST_COMPRESSION);
+
+    // Decompresses into `mOut`, throwing unless the data decompresses to
+    // exactly `mOutSize` bytes.
+    void zlibDecompress(const char* mData, std::size_t mSize, char* mOut,
+        std::size_t mOutSize);
 }
 
 #endif
@@ -21,7 +21,12 @@
 #define HG_NKEY1 123456
 #endif
 
+// `HG_ENCRYPT(X)` must equal `HG_ENCRYPT_PREFIX + X + HG_ENCRYPT_SUFFIX`.
+// Builds that override `HG_ENCRYPT` without also defining the prefix and
+// suffix fall back to hashing fully buffered validator sources.
 #ifndef HG_ENCRYPT
+#define HG_ENCRYPT_PREFIX toStr(HG_NKEY1)
+#define HG_ENCRYPT_SUFFIX std::string{HG_SKEY1} + HG_SKEY2 + HG_SKEY3
 #define HG_ENCRYPT(X) toStr(HG_NKEY1) + X + HG_SKEY1 + HG_SKEY2 + HG_SKEY3
 #endif
 
@@ -0,0 +1,146 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_JOURNAL
+#define HG_ONLINE_JOURNAL
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Append-only binary log of records. Every record is framed with
+        // its size and a checksum, so that one torn by a crash is detected
+        // and dropped on replay. Appending is thread-safe, and every record
+        // reaches the OS before `append` returns.
+        // Offsets given and taken by the functions below are those of the
+        // records' payloads in the file.
+        class Journal
+        {
+        public:
+            // Builds the payload of a record.
+            class Writer
+            {
+            private:
+                std::string data;
+
+            public:
+                template <typename T>
+                inline Writer& operator<<(const T& mValue)
+                {
+                    static_assert(std::is_arithmetic<T>::value, "");
+                    data.append(
+                        reinterpret_cast<const char*>(&mValue), sizeof(T));
+                    return *this;
+                }
+                inline Writer& operator<<(const std::string& mValue)
+                {
+                    *this << std::uint32_t(mValue.size());
+                    data += mValue;
+                    return *this;
+                }
+
+                inline const std::string& getData() const { return data; }
+            };
+
+            // Reads the payload of a record, throwing `std::runtime_error`
+            // if it is shorter than expected.
+            class Reader
+            {
+            private:
+                const char* ptr;
+                const char* end;
+
+                inline void require(SizeT mSize)
+                {
+                    if(SizeT(end - ptr) < mSize)
+                        throw std::runtime_error("truncated journal record");
+                }
+
+            public:
+                inline Reader(const char* mData, SizeT mSize)
+                    : ptr{mData}, end{mData + mSize}
+                {
+                }
+
+                template <typename T>
+                inline Reader& operator>>(T& mValue)
+                {
+                    static_assert(std::is_arithmetic<T>::value, "");
+                    require(sizeof(T));
+                    std::memcpy(&mValue, ptr, sizeof(T));
+                    ptr += sizeof(T);
+                    return *this;
+                }
+                inline Reader& operator>>(std::string& mValue)
+                {
+                    std::uint32_t size;
+                    *this >> size;
+                    require(size);
+                    mValue.assign(ptr, size);
+                    ptr += size;
+                    return *this;
+                }
+            };
+
+        private:
+            std::mutex mutex;
+            std::string path;
+            std::ofstream file;
+            std::uint64_t size{0};
+
+        public:
+            // Size of the frame preceding every record.
+            static constexpr SizeT headerSize{2 * sizeof(std::uint32_t)};
+
+            inline Journal(const std::string& mPath) : path{mPath} {}
+
+            // Appends to the first `mKeepSize` bytes of the file, dropping
+            // the rest, or starts an empty file if `mKeepSize` is 0.
+            void open(std::uint64_t mKeepSize = 0);
+            void close();
+
+            // Returns the offset of the record.
+            std::uint64_t append(const Writer& mRecord);
+
+            // Moves the records written so far to `mPath`, which must not
+            // exist, and starts an empty journal. On failure, returns false
+            // and keeps appending to the same file.
+            bool rotate(const std::string& mPath);
+
+            inline std::uint64_t getSize()
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                return size;
+            }
+
+            // Writes a framed record to `mOut`, e.g. to build a file that is
+            // replayed later.
+            static void write(std::ostream& mOut, const Writer& mRecord);
+
+            // Calls `mFn(reader, offset)` for every intact record of the
+            // journal at `mPath` between `mFrom` and `mTo`, in order, and
+            // returns the end of the last one. A missing file holds no
+            // records. Only a torn record at the end, left by a crash, is
+            // dropped: if the file cannot be read, or a damaged record is
+            // followed by data, `std::runtime_error` is thrown instead.
+            // Records `mFn` cannot read are skipped.
+            // The file may be appended to meanwhile; records written after
+            // `mTo` are not read.
+            static std::uint64_t replay(const std::string& mPath,
+                const ssvu::Func<void(Reader&, std::uint64_t)>& mFn,
+                std::uint64_t mFrom = 0,
+                std::uint64_t mTo = std::numeric_limits<std::uint64_t>::max());
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_LEADERBOARD
+#define HG_ONLINE_LEADERBOARD
+
+#include <random>
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Scores sorted from best to worst, ties broken by username, kept in
+        // a treap whose nodes know the size of their subtree. Insertion,
+        // removal, ranking and reading the first `k` entries take
+        // O(log n) expected time (plus `k` for the latter). Scores must be
+        // finite: NaN would break the ordering.
+        class Leaderboard
+        {
+        private:
+            struct Node
+            {
+                float score;
+                std::string username;
+                std::uint32_t priority;
+                SizeT size{1};
+                UPtr<Node> left, right;
+
+                inline Node(float mScore, const std::string& mUsername,
+                    std::uint32_t mPriority)
+                    : score{mScore}, username{mUsername}, priority{mPriority}
+                {
+                }
+            };
+
+            UPtr<Node> root;
+            std::minstd_rand rng;
+
+            inline static SizeT getSize(const UPtr<Node>& mNode)
+            {
+                return mNode == nullptr ? 0 : mNode->size;
+            }
+            inline static void updateSize(Node& mNode)
+            {
+                mNode.size = 1 + getSize(mNode.left) + getSize(mNode.right);
+            }
+
+            // Whether (`mScore`, `mUsername`) comes before `mNode`.
+            inline static bool isBefore(
+                float mScore, const std::string& mUsername, const Node& mNode)
+            {
+                if(mScore != mNode.score) return mScore > mNode.score;
+                return mUsername < mNode.username;
+            }
+
+            // Moves the entries of `mNode` that come before the key to
+            // `mLeft`, or at or before it if `mInclusive`, and the rest to
+            // `mRight`.
+            static void split(UPtr<Node> mNode, float mScore,
+                const std::string& mUsername, bool mInclusive,
+                UPtr<Node>& mLeft, UPtr<Node>& mRight);
+
+            // Every entry of `mLeft` must come before those of `mRight`.
+            static UPtr<Node> merge(UPtr<Node> mLeft, UPtr<Node> mRight);
+
+            static void fillTop(const UPtr<Node>& mNode, SizeT mCount,
+                std::vector<std::pair<std::string, float>>& mResult);
+
+        public:
+            // The entry must not already be in the leaderboard.
+            void insert(float mScore, const std::string& mUsername);
+            void erase(float mScore, const std::string& mUsername);
+
+            // 1-based position of an entry that is in the leaderboard.
+            SizeT getRank(float mScore, const std::string& mUsername) const;
+
+            // The first `mCount` entries, best first.
+            std::vector<std::pair<std::string, float>> getTop(
+                SizeT mCount) const;
+
+            inline SizeT getSize() const { return getSize(root); }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_LOGSTORAGE
+#define HG_ONLINE_LOGSTORAGE
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Online/Journal.hpp"
+#include "SSVOpenHexagon/Online/Storage.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Keeps only the keys in memory, each with the location of its
+        // latest value in an append-only data file. Replaced values are
+        // dropped by rewriting the file once most of it is garbage.
+        // A hint file lists the locations of every key as of some point of
+        // the data file, so that opening the storage only has to read the
+        // data written after it.
+        // Hints and rewritten files are built from the part of the data
+        // file written before they start, which does not change, so that
+        // records can be put meanwhile.
+        class LogStorage : public Storage
+        {
+        private:
+            struct Location
+            {
+                std::uint64_t offset;
+                std::uint32_t size;
+            };
+            using Keys = std::map<std::string, Location>;
+
+            static constexpr std::uint64_t mergeSize{16 * 1024 * 1024};
+            static constexpr std::uint64_t hintInterval{1024 * 1024};
+
+            std::mutex mutex, compactionMutex;
+            Keys keys;
+            std::string dataPath, hintPath;
+            Journal data;
+            std::ifstream reader;
+
+            // Size of the records still in use. Guarded by `mutex`.
+            std::uint64_t liveSize{0};
+
+            // Size of the data file when the hint was last written. Guarded
+            // by `compactionMutex`.
+            std::uint64_t hintEnd{0};
+
+            inline static std::uint64_t getRecordSize(
+                const std::string& mKey, std::uint32_t mSize)
+            {
+                return Journal::headerSize + 2 * sizeof(std::uint32_t) +
+                       mKey.size() + mSize;
+            }
+
+            static void track(Keys& mKeys, std::uint64_t& mLiveSize,
+                const std::string& mKey, std::uint64_t mOffset,
+                std::uint32_t mSize);
+            static std::uint64_t replayData(const std::string& mPath,
+                Keys& mKeys, std::uint64_t& mLiveSize, std::uint64_t mFrom,
+                std::uint64_t mTo);
+            std::uint64_t readKeys(Keys& mKeys, std::uint64_t& mLiveSize,
+                std::uint64_t& mHintEnd, std::uint64_t mTo);
+
+            bool readValue(const Location& mLocation, std::string& mValue);
+            bool writeHint(std::uint64_t mDataEnd);
+            void merge(std::uint64_t mDataEnd);
+
+        public:
+            LogStorage(const std::string& mPath);
+            ~LogStorage();
+
+            bool has(const std::string& mKey) override;
+            bool get(const std::string& mKey, std::string& mValue) override;
+            void put(
+                const std::string& mKey, const std::string& mValue) override;
+
+            void scanKeys(
+                const std::string& mPrefix, const KeyFn& mFn) override;
+            void scan(
+                const std::string& mPrefix, const RecordFn& mFn) override;
+
+            bool isEmpty() override;
+            void compact() override;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_MEMORYSTORAGE
+#define HG_ONLINE_MEMORYSTORAGE
+
+#include <map>
+#include <mutex>
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Online/Journal.hpp"
+#include "SSVOpenHexagon/Online/Storage.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Keeps every record in memory. Records are appended to a journal
+        // as they are put, which is folded into a snapshot of all records
+        // once it grows large, and when the storage is opened.
+        // Snapshots are built from the files alone, so that records can be
+        // put meanwhile: the journal is moved aside, and the new snapshot
+        // is the old one updated with the records of that journal.
+        class MemoryStorage : public Storage
+        {
+        private:
+            using Records = std::map<std::string, std::string>;
+
+            static constexpr std::uint64_t compactionSize{16 * 1024 * 1024};
+
+            std::mutex mutex, compactionMutex;
+            Records records;
+            std::string snapshotPath, journalPath, oldJournalPath;
+            Journal journal;
+
+            static void replay(const std::string& mPath, Records& mRecords);
+            bool saveSnapshot(const Records& mRecords);
+
+        public:
+            // Throws `std::runtime_error` if the snapshot cannot be saved.
+            MemoryStorage(const std::string& mPath);
+
+            bool has(const std::string& mKey) override;
+            bool get(const std::string& mKey, std::string& mValue) override;
+            void put(
+                const std::string& mKey, const std::string& mValue) override;
+
+            void scanKeys(
+                const std::string& mPrefix, const KeyFn& mFn) override;
+            void scan(
+                const std::string& mPrefix, const RecordFn& mFn) override;
+
+            bool isEmpty() override;
+            void compact() override;
+        };
+    }
+}
+
+#endif
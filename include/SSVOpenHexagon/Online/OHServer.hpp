@@ -1,13 +1,21 @@
 #ifndef HG_ONLINE_OHSERVER
 #define HG_ONLINE_OHSERVER
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Global/Config.hpp"
+#include "SSVOpenHexagon/Online/Journal.hpp"
+#include "SSVOpenHexagon/Online/Leaderboard.hpp"
 #include "SSVOpenHexagon/Online/PacketHandler.hpp"
 #include "SSVOpenHexagon/Online/Server.hpp"
+#include "SSVOpenHexagon/Online/Storage.hpp"
 #include "SSVOpenHexagon/Online/Online.hpp"
 #include "SSVOpenHexagon/Online/Definitions.hpp"
 #include "SSVOpenHexagon/Online/Utils.hpp"
@@ -26,131 +34,375 @@ namespace hg
             std::string passwordHash, email;
             UserStats stats;
         };
-        class UserDB
+
+        inline std::string getUserValue(const User& mUser)
         {
-            template <typename T>
-            friend struct ssvuj::Converter;
+            const auto& st(mUser.stats);
+
+            Journal::Writer w;
+            w << mUser.passwordHash << mUser.email
+              << std::uint32_t(st.minutesSpentPlaying)
+              << std::uint32_t(st.deaths) << std::uint32_t(st.restarts)
+              << std::uint32_t(st.trackedNames.size());
+            for(const auto& n : st.trackedNames) w << n;
+
+            return w.getData();
+        }
+        inline User readUserValue(const std::string& mValue)
+        {
+            User result;
+            auto& st(result.stats);
+
+            Journal::Reader r{mValue.data(), mValue.size()};
+            std::uint32_t minutes, deaths, restarts, trackedCount;
+            r >> result.passwordHash >> result.email >> minutes >> deaths >>
+                restarts >> trackedCount;
 
+            st.minutesSpentPlaying = minutes;
+            st.deaths = deaths;
+            st.restarts = restarts;
+            st.trackedNames.resize(trackedCount);
+            for(auto& n : st.trackedNames) r >> n;
+
+            return result;
+        }
+
+        // Users are stored under "u:<username>". Changes are written
+        // through to the storage before returning.
+        class UserDB
+        {
         private:
-            std::unordered_map<std::string, User> users;
+            Storage& storage;
+
+            // Held while a user is read, modified and written back.
+            std::mutex mutex;
+
+            inline static std::string getKey(const std::string& mUsername)
+            {
+                return "u:" + mUsername;
+            }
+
+            inline User getUser(const std::string& mUsername) const
+            {
+                std::string value;
+                if(!storage.get(getKey(mUsername), value)) return User{};
+
+                return readUserValue(value);
+            }
 
         public:
+            inline UserDB(Storage& mStorage) : storage(mStorage) {}
+
             inline bool hasUser(const std::string& mUsername) const
             {
-                return users.count(mUsername) > 0;
+                return storage.has(getKey(mUsername));
             }
-            inline User& getUser(const std::string& mUsername)
+
+            // Returns false, without changing anything, if `mUsername` is
+            // already registered.
+            inline bool tryRegisterUser(
+                const std::string& mUsername, const User& mUser)
             {
-                return users[mUsername];
+                std::lock_guard<std::mutex> lock{mutex};
+                if(hasUser(mUsername)) return false;
+
+                storage.put(getKey(mUsername), getUserValue(mUser));
+                return true;
             }
-            inline void registerUser(
-                const std::string& mUsername, const User& mUser)
+
+            // Returns `mFn(const User&)`. Missing users read as new ones.
+            template <typename TF>
+            inline auto withUser(
+                const std::string& mUsername, const TF& mFn) const
+            {
+                return mFn(getUser(mUsername));
+            }
+
+            // Calls `mFn(User&)`, creating the user if needed.
+            template <typename TF>
+            inline void modifyUser(const std::string& mUsername, const TF& mFn)
             {
-                users[mUsername] = mUser;
+                std::lock_guard<std::mutex> lock{mutex};
+
+                auto u(getUser(mUsername));
+                mFn(u);
+                storage.put(getKey(mUsername), getUserValue(u));
             }
-            inline const std::unordered_map<std::string, User>& getUsers() const
+
+            inline void putUser(const std::string& mUsername, const User& mUser)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                storage.put(getKey(mUsername), getUserValue(mUser));
+            }
+
+            inline std::vector<std::string> getUsernames() const
             {
-                return users;
+                std::vector<std::string> result;
+                storage.scanKeys("u:", [&result](const std::string& mKey)
+                    {
+                        result.emplace_back(mKey.substr(2));
+                    });
+
+                return result;
             }
             inline void setEmail(
                 const std::string& mUsername, std::string mEmail)
             {
-                users[mUsername].email = ssvu::mv(mEmail);
+                modifyUser(mUsername, [&mEmail](User& mU)
+                    {
+                        mU.email = ssvu::mv(mEmail);
+                    });
             }
         };
-        class LevelScoreDB
+        // Difficulty multiplier in thousandths, so that multipliers sent by
+        // clients or read back from JSON always find the same board.
+        using DiffKey = int;
+
+        // Multipliers sent by clients are checked against this before
+        // being turned into keys, which must fit a `DiffKey`.
+        constexpr float maxDiffMult{1000.f};
+        inline bool isValidDiffMult(float mDiffMult)
         {
-        private:
-            std::unordered_map<float, std::unordered_map<std::string, float>>
-                scores;
-            std::unordered_map<float, std::map<float, std::string>>
-                sortedScores;
-            std::unordered_map<float, std::unordered_map<std::string, int>>
-                userPositions;
+            return std::isfinite(mDiffMult) && mDiffMult > 0.f &&
+                   mDiffMult <= maxDiffMult;
+        }
+        inline DiffKey getDiffKey(float mDiffMult)
+        {
+            return DiffKey(std::lround(mDiffMult * 1000.f));
+        }
 
+        class LevelScoreDB
+        {
         public:
-            inline void addScore(
-                float mDiffMult, const std::string& mUsername, float mScore)
+            struct Board
             {
-                scores[mDiffMult][mUsername] = mScore;
+                DiffKey key;
+                std::unordered_map<std::string, float> scores;
+                Leaderboard leaderboard;
+
+                // Response listing the top scores, empty until requested
+                // and whenever they change.
+                Payload topPayload;
+            };
+
+            // Number of scores listed by the response of a board.
+            static constexpr SizeT topSize{9};
 
-                auto& ss(sortedScores[mDiffMult]);
-                for(auto itr(std::begin(ss)); itr != std::end(ss); ++itr)
-                    if(itr->second == mUsername)
+        private:
+            // Sorted by key. A level has only a few difficulties, so a
+            // contiguous array beats hashing.
+            std::vector<Board> boards;
+
+            template <typename TBoards>
+            inline static auto lowerBound(TBoards& mBoards, DiffKey mKey)
+            {
+                return std::lower_bound(std::begin(mBoards), std::end(mBoards),
+                    mKey, [](const Board& mB, DiffKey mK)
                     {
-                        ss.erase(itr);
-                        break;
-                    }
-                ss.emplace(mScore, mUsername);
+                        return mB.key < mK;
+                    });
+            }
+
+            inline const Board* findBoard(DiffKey mKey) const
+            {
+                auto itr(lowerBound(boards, mKey));
+                if(itr == std::end(boards) || itr->key != mKey) return nullptr;
+
+                return &*itr;
+            }
+            inline Board& getBoard(DiffKey mKey)
+            {
+                auto itr(lowerBound(boards, mKey));
+                if(itr == std::end(boards) || itr->key != mKey)
+                    itr = boards.insert(itr, Board{mKey, {}, {}, {}});
 
-                int i{1};
-                for(const auto& p : ssvu::asRangeReverse(ss))
-                    userPositions[mDiffMult][p.second] = i++;
+                return *itr;
             }
 
-            inline bool hasDiffMult(float mDiffMult) const
+        public:
+            inline void addScore(
+                DiffKey mKey, const std::string& mUsername, float mScore)
             {
-                return scores.count(mDiffMult) > 0;
+                auto& b(getBoard(mKey));
+                bool topChanged{false};
+
+                auto itr(b.scores.find(mUsername));
+                if(itr != std::end(b.scores))
+                {
+                    topChanged =
+                        b.leaderboard.getRank(itr->second, mUsername) <=
+                        topSize;
+                    b.leaderboard.erase(itr->second, mUsername);
+                }
+
+                b.leaderboard.insert(mScore, mUsername);
+                b.scores[mUsername] = mScore;
+
+                if(topChanged ||
+                    b.leaderboard.getRank(mScore, mUsername) <= topSize)
+                    b.topPayload.data.clear();
             }
-            inline const std::unordered_map<float,
-                std::unordered_map<std::string, float>>&
-            getScores() const
+
+            inline bool hasDiffKey(DiffKey mKey) const
             {
-                return scores;
+                return findBoard(mKey) != nullptr;
             }
-            inline const std::unordered_map<std::string, float>& getScores(
-                float mDiffMult) const
+            inline const std::vector<Board>& getBoards() const
             {
-                return scores.at(mDiffMult);
+                return boards;
             }
-            inline const std::map<float, std::string>& getSortedScores(
-                float mDiffMult) const
+            // Returns the response listing the best `topSize` scores of the
+            // board, which is built by `mFn(top)` only when they changed.
+            // `top` holds the players and their scores, best first.
+            template <typename TF>
+            inline const Payload& getTopPayload(DiffKey mKey, const TF& mFn)
             {
-                return sortedScores.at(mDiffMult);
+                auto& b(getBoard(mKey));
+                if(b.topPayload.data.empty())
+                    b.topPayload = mFn(b.leaderboard.getTop(topSize));
+
+                return b.topPayload;
             }
             inline float getPlayerScore(
-                const std::string& mUsername, float mDiffMult) const
+                const std::string& mUsername, DiffKey mKey) const
             {
-                if(scores.count(mDiffMult) == 0 ||
-                    scores.at(mDiffMult).count(mUsername) == 0)
-                    return -1.f;
-                return scores.at(mDiffMult).at(mUsername);
+                const auto b(findBoard(mKey));
+                if(b == nullptr) return -1.f;
+
+                auto itr(b->scores.find(mUsername));
+                return itr == std::end(b->scores) ? -1.f : itr->second;
             }
             inline int getPlayerPosition(
-                const std::string& mUsername, float mDiffMult) const
+                const std::string& mUsername, DiffKey mKey) const
             {
-                if(userPositions.count(mDiffMult) == 0 ||
-                    userPositions.at(mDiffMult).count(mUsername) == 0)
-                    return -1;
-                return userPositions.at(mDiffMult).at(mUsername);
+                float score{getPlayerScore(mUsername, mKey)};
+                if(score == -1.f) return -1;
+
+                return int(findBoard(mKey)->leaderboard.getRank(
+                    score, mUsername));
             }
         };
+        // Scores are stored under "s:<level id>\n<difficulty>\n<username>".
+        // The scores of a level are read into its leaderboards the first
+        // time the level is used, and kept in memory from then on.
+        // Levels are split between shards by id, each with its own lock, so
+        // that scores of different levels are mostly handled in parallel.
         class ScoreDB
         {
-            template <typename T>
-            friend struct ssvuj::Converter;
-
         private:
-            std::unordered_map<std::string, LevelScoreDB> levels;
+            struct Shard
+            {
+                std::mutex mutex;
+                std::unordered_map<std::string, LevelScoreDB> levels;
+            };
 
-        public:
-            inline bool hasLevel(const std::string& mId) const
+            static constexpr SizeT shardCount{16};
+            Storage& storage;
+            std::array<Shard, shardCount> shards;
+
+            inline Shard& getShard(const std::string& mId)
+            {
+                return shards[std::hash<std::string>{}(mId) % shardCount];
+            }
+
+            inline static std::string getLevelPrefix(const std::string& mId)
+            {
+                return "s:" + mId + "\n";
+            }
+            inline static std::string getKey(const std::string& mId,
+                DiffKey mKey, const std::string& mUsername)
             {
-                return levels.count(mId) > 0;
+                return getLevelPrefix(mId) + ssvu::toStr(mKey) + "\n" +
+                       mUsername;
             }
-            inline LevelScoreDB& getLevel(const std::string& mId)
+            inline static std::string getScoreValue(float mScore)
             {
-                return levels[mId];
+                Journal::Writer w;
+                w << mScore;
+                return w.getData();
             }
-            inline void addLevel(
-                const std::string& mId, const LevelScoreDB& mDB)
+
+            inline LevelScoreDB loadLevel(const std::string& mId)
             {
-                levels[mId] = mDB;
+                const auto prefix(getLevelPrefix(mId));
+
+                LevelScoreDB result;
+                storage.scan(prefix, [&](const std::string& mKey,
+                                         const std::string& mValue)
+                    {
+                        auto sep(mKey.find('\n', prefix.size()));
+                        if(sep == std::string::npos) return;
+
+                        float score;
+                        Journal::Reader r{mValue.data(), mValue.size()};
+                        r >> score;
+                        if(!std::isfinite(score)) return;
+
+                        result.addScore(
+                            std::stoi(mKey.substr(
+                                prefix.size(), sep - prefix.size())),
+                            mKey.substr(sep + 1), score);
+                    });
+
+                return result;
             }
-            inline const std::unordered_map<std::string, LevelScoreDB>&
-            getLevels() const
+
+            // Returns nullptr if `mCreate` is false and the level has no
+            // scores. Must be called with the shard locked.
+            inline LevelScoreDB* findLevel(
+                Shard& mShard, const std::string& mId, bool mCreate)
             {
-                return levels;
+                auto itr(mShard.levels.find(mId));
+                if(itr != std::end(mShard.levels)) return &itr->second;
+
+                auto level(loadLevel(mId));
+                if(!mCreate && level.getBoards().empty()) return nullptr;
+
+                return &(mShard.levels[mId] = ssvu::mv(level));
+            }
+
+        public:
+            inline ScoreDB(Storage& mStorage) : storage(mStorage) {}
+
+            // Keeps `mScore` if it beats the player's previous one, and
+            // returns whether it did.
+            inline bool submitScore(const std::string& mId, DiffKey mKey,
+                const std::string& mUsername, float mScore)
+            {
+                auto& s(getShard(mId));
+                std::lock_guard<std::mutex> lock{s.mutex};
+
+                auto& l(*findLevel(s, mId, true));
+                if(l.getPlayerScore(mUsername, mKey) >= mScore) return false;
+
+                l.addScore(mKey, mUsername, mScore);
+                storage.put(
+                    getKey(mId, mKey, mUsername), getScoreValue(mScore));
+                return true;
+            }
+
+            // Replaces the player's score. Only meant for importing scores
+            // before any level is used.
+            inline void putScore(const std::string& mId, DiffKey mKey,
+                const std::string& mUsername, float mScore)
+            {
+                storage.put(
+                    getKey(mId, mKey, mUsername), getScoreValue(mScore));
+            }
+
+            // Calls `mFn(LevelScoreDB&)` with the level's shard locked.
+            // Returns false if the level has no scores.
+            template <typename TF>
+            inline bool withLevelIfExists(const std::string& mId, const TF& mFn)
+            {
+                auto& s(getShard(mId));
+                std::lock_guard<std::mutex> lock{s.mutex};
+
+                const auto l(findLevel(s, mId, false));
+                if(l == nullptr) return false;
+
+                mFn(*l);
+                return true;
             }
         };
     }
@@ -173,48 +425,6 @@ namespace ssvuj
             "st", mValue.stats);
     }
     SSVUJ_CNV_SIMPLE_END();
-    template <>
-    SSVUJ_CNV_SIMPLE(hg::Online::UserDB, mObj, mValue)
-    {
-        ssvuj::convert(mObj, mValue.users);
-    }
-    SSVUJ_CNV_SIMPLE_END();
-    template <>
-    SSVUJ_CNV_SIMPLE(hg::Online::ScoreDB, mObj, mValue)
-    {
-        ssvuj::convert(mObj, mValue.levels);
-    }
-    SSVUJ_CNV_SIMPLE_END();
-
-    template <>
-    struct Converter<hg::Online::LevelScoreDB>
-    {
-        using T = hg::Online::LevelScoreDB;
-        inline static void fromObj(const Obj& mObj, T& mValue)
-        {
-            for(auto itr(std::begin(mObj)); itr != std::end(mObj); ++itr)
-            {
-                for(auto i(0u); i < getObjSize(*itr); ++i)
-                    mValue.addScore(ssvu::sToFloat(getKey(itr)),
-                        getExtr<std::string>((*itr)[i], 0),
-                        getExtr<float>((*itr)[i], 1));
-            }
-        }
-        inline static void toObj(Obj& mObj, const T& mValue)
-        {
-            for(const auto& s : mValue.getScores())
-            {
-                auto i(0u);
-                for(const auto& r : s.second)
-                {
-                    Obj temp;
-                    arch(temp, 0, r.first);
-                    arch(temp, 1, r.second);
-                    arch(mObj[ssvu::toStr(s.first)], i++, temp);
-                }
-            }
-        }
-    };
 }
 
 namespace hg
@@ -224,30 +434,42 @@ namespace hg
         class LoginDB
         {
         private:
+            mutable std::mutex mutex;
             ssvu::Bimap<std::string, unsigned int> logins;
 
         public:
             inline bool isLoggedIn(const std::string& mUsername) const
             {
+                std::lock_guard<std::mutex> lock{mutex};
                 return logins.has(mUsername);
             }
-            inline void acceptLogin(
+
+            // Returns false if `mUsername` is already logged in.
+            inline bool tryAcceptLogin(
                 unsigned int mUid, const std::string& mUsername)
             {
+                std::lock_guard<std::mutex> lock{mutex};
+                if(logins.has(mUsername)) return false;
+
                 logins.emplace(mUsername, mUid);
+                return true;
             }
 
             inline void forceLogout(unsigned int mUid)
             {
+                std::lock_guard<std::mutex> lock{mutex};
                 if(logins.has(mUid)) logins.erase(mUid);
             }
             inline void logout(const std::string& mUsername)
             {
+                std::lock_guard<std::mutex> lock{mutex};
                 if(logins.has(mUsername)) logins.erase(mUsername);
             }
 
             inline std::vector<std::string> getLoggedUsernames() const
             {
+                std::lock_guard<std::mutex> lock{mutex};
+
                 std::vector<std::string> result;
                 for(const auto& p : logins) result.emplace_back(p->first);
                 return result;
@@ -258,40 +480,97 @@ namespace hg
         {
             ssvucl::Ctx ctx;
 
-            bool modifiedUsers{false}, modifiedScores{false};
-
+            // Written by older servers, which kept the databases in memory.
+            // Imported when the storage is empty.
             const std::string usersPath{"users.json"};
             const std::string scoresPath{"scores.json"};
 
-            UserDB users{ssvuj::getExtr<UserDB>(ssvuj::getFromFile(usersPath))};
-            ScoreDB scores{
-                ssvuj::getExtr<ScoreDB>(ssvuj::getFromFile(scoresPath))};
+            UPtr<Storage> storage{
+                createStorage(Config::getServerStorage(), "server")};
+
+            // Shared by the packet handlers, which run on several threads.
+            UserDB users{*storage};
+            ScoreDB scores{*storage};
             PacketHandler<ClientHandler> pHandler;
             Server server{pHandler};
             LoginDB loginDB; // currently logged-in users and uids
 
             std::future<void> inputFuture, saveFuture;
 
-            inline void saveUsers() const
+            inline void importLegacyDatabases()
             {
-                ssvuj::Obj root;
-                ssvuj::arch(root, users);
-                ssvuj::writeToFile(root, usersPath);
+                if(Path{usersPath}.exists<ssvufs::Type::File>())
+                {
+                    const auto root(ssvuj::getFromFile(usersPath));
+                    for(auto itr(std::begin(root)); itr != std::end(root);
+                        ++itr)
+                        users.putUser(
+                            ssvuj::getKey(itr), ssvuj::getExtr<User>(*itr));
+
+                    ssvu::lo("OHServer") << "Imported " << usersPath << "\n";
+                }
+
+                if(Path{scoresPath}.exists<ssvufs::Type::File>())
+                {
+                    const auto root(ssvuj::getFromFile(scoresPath));
+                    for(auto lItr(std::begin(root)); lItr != std::end(root);
+                        ++lItr)
+                        for(auto dItr(std::begin(*lItr));
+                            dItr != std::end(*lItr); ++dItr)
+                        {
+                            const auto& id(ssvuj::getKey(lItr));
+                            const auto diffMult(
+                                ssvu::sToFloat(ssvuj::getKey(dItr)));
+                            if(!isValidDiffMult(diffMult)) continue;
+
+                            auto key(getDiffKey(diffMult));
+
+                            for(auto i(0u); i < ssvuj::getObjSize(*dItr); ++i)
+                            {
+                                const auto score(
+                                    ssvuj::getExtr<float>((*dItr)[i], 1));
+                                if(!std::isfinite(score)) continue;
+
+                                scores.putScore(id, key,
+                                    ssvuj::getExtr<std::string>((*dItr)[i], 0),
+                                    score);
+                            }
+                        }
+
+                    ssvu::lo("OHServer") << "Imported " << scoresPath << "\n";
+                }
             }
-            inline void saveScores() const
+
+            template <FromClient TType, typename TF>
+            inline void modifyUserFromPacket(PacketReader& mP, const TF& mFn)
             {
-                ssvuj::Obj root;
-                ssvuj::arch(root, scores);
-                ssvuj::writeToFile(root, scoresPath);
+                std::string username;
+                extrPacket<TType>(mP, username);
+                users.modifyUser(username, mFn);
             }
-            inline User& getUserFromPacket(sf::Packet& mP)
+
+            // The top scores are encoded, and compressed if worth it, once.
+            // They are then sent as they are until they change, followed
+            // only by the player's own score and position.
+            inline static sf::Packet getLeaderboardResponse(LevelScoreDB& mL,
+                const std::string& mUsername, const std::string& mLevelId,
+                DiffKey mKey)
             {
-                return users.getUser(
-                    ssvuj::getExtr<std::string>(getDecompressedPacket(mP), 0));
+                const auto& top(mL.getTopPayload(mKey, [&](const auto& mTop)
+                    {
+                        PacketWriter w;
+                        w << mLevelId << mTop;
+                        return w.getPayload();
+                    }));
+
+                return buildPacket<FromServer::SendLeaderboard>(top,
+                    mL.getPlayerScore(mUsername, mKey),
+                    mL.getPlayerPosition(mUsername, mKey));
             }
 
             OHServer()
             {
+                if(storage->isEmpty()) importLegacyDatabases();
                 ssvu::lo() << "OHServer constructed\n";
 
                 server.onClientAccepted += [this](ClientHandler& mCH)
@@ -301,33 +580,45 @@ namespace hg
                         loginDB.forceLogout(mCH.getUid());
                     };
                 };
-                pHandler[FromClient::Ping] = [](ClientHandler&, sf::Packet&)
+                pHandler[FromClient::Ping] = [](ClientHandler&, PacketReader&)
                 {
                 };
                 pHandler[FromClient::Login] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
                     bool newUserRegistration{false};
 
+                    // The client only sends its password, so the hash
+                    // stays empty.
                     std::string username, password, passwordHash;
-                    ssvuj::extrArray(getDecompressedPacket(mP), username,
-                        password, passwordHash);
+                    extrPacket<FromClient::Login>(mP, username, password);
 
                     if(loginDB.isLoggedIn(username))
                     {
                         HG_LO_VERBOSE("PacketHandler")
                             << "User already logged in\n";
                         mMS.send(
-                            buildCPacket<FromServer::LoginResponseInvalid>());
+                            buildPacket<FromServer::LoginResponseInvalid>());
                         return;
                     }
 
-                    if(users.hasUser(username))
+                    User newUser;
+                    newUser.passwordHash = passwordHash;
+
+                    if(users.tryRegisterUser(username, newUser))
+                    {
+                        HG_LO_VERBOSE("PacketHandler")
+                            << "Username not found, registering\n";
+                        newUserRegistration = true;
+                    }
+                    else
                     {
-                        const auto& u(users.getUser(username));
                         HG_LO_VERBOSE("PacketHandler") << "Username found\n";
 
-                        if(u.passwordHash == passwordHash)
+                        if(users.withUser(username, [&](const User& mU)
+                               {
+                                   return mU.passwordHash == passwordHash;
+                               }))
                         {
                             HG_LO_VERBOSE("PacketHandler")
                                 << "Password valid\n";
@@ -336,57 +627,51 @@ namespace hg
                         {
                             HG_LO_VERBOSE("PacketHandler")
                                 << "Password invalid\n";
-                            mMS.send(buildCPacket<
+                            mMS.send(buildPacket<
                                 FromServer::LoginResponseInvalid>());
                             return;
                         }
                     }
-                    else
+
+                    // Another client may have logged in with the same name
+                    // since the first check.
+                    if(!loginDB.tryAcceptLogin(mMS.getUid(), username))
                     {
                         HG_LO_VERBOSE("PacketHandler")
-                            << "Username not found, registering\n";
-                        User newUser;
-                        newUser.passwordHash = passwordHash;
-                        users.registerUser(username, newUser);
-                        modifiedUsers = true;
-                        newUserRegistration = true;
+                            << "User already logged in\n";
+                        mMS.send(
+                            buildPacket<FromServer::LoginResponseInvalid>());
+                        return;
                     }
 
                     HG_LO_VERBOSE("PacketHandler") << "Accepting user\n";
-                    loginDB.acceptLogin(mMS.getUid(), username);
-                    mMS.send(buildCPacket<FromServer::LoginResponseValid>(
+                    mMS.send(buildPacket<FromServer::LoginResponseValid>(
                         newUserRegistration));
                 };
                 pHandler[FromClient::RequestInfo] = [](
-                    ClientHandler& mMS, sf::Packet&)
+                    ClientHandler& mMS, PacketReader&)
                 {
                     float version{2.f};
                     std::string message{"Welcome to Open Hexagon 2.0!"};
-                    mMS.send(buildCPacket<FromServer::RequestInfoResponse>(
+                    mMS.send(buildPacket<FromServer::RequestInfoResponse>(
                         version, message));
                 };
                 pHandler[FromClient::SendScore] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
                     std::string username, levelId, validator;
                     float diffMult, score;
-                    ssvuj::extrArray(getDecompressedPacket(mP), username,
-                        levelId, validator, diffMult, score);
+                    extrPacket<FromClient::SendScore>(
+                        mP, username, levelId, validator, diffMult, score);
 
-                    if(!loginDB.isLoggedIn(username))
+                    if(!isValidDiffMult(diffMult) || !std::isfinite(score) ||
+                        !loginDB.isLoggedIn(username))
                     {
-                        mMS.send(buildCPacket<
+                        mMS.send(buildPacket<
                             FromServer::SendScoreResponseInvalid>());
                         return;
                     }
 
-                    if(!scores.hasLevel(levelId))
-                    {
-                        HG_LO_VERBOSE("PacketHandler")
-                            << "No table for this level id, creating one\n";
-                        scores.addLevel(levelId, {});
-                    }
-
                     if(Online::getValidators().getValidator(levelId) !=
                         validator)
                     {
@@ -394,46 +679,44 @@ namespace hg
                             << "Validator mismatch!\n"
                             << Online::getValidators().getValidator(levelId)
                             << "\n" << validator << "\n";
-                        mMS.send(buildCPacket<
+                        mMS.send(buildPacket<
                             FromServer::SendScoreResponseInvalid>());
                         return;
                     }
 
                     HG_LO_VERBOSE("PacketHandler")
                         << "Validator matches, inserting score\n";
-                    auto& l(scores.getLevel(levelId));
-                    if(l.getPlayerScore(username, diffMult) < score)
-                    {
-                        l.addScore(diffMult, username, score);
-                        modifiedScores = true;
-                    }
+                    scores.submitScore(
+                        levelId, getDiffKey(diffMult), username, score);
                     mMS.send(
-                        buildCPacket<FromServer::SendScoreResponseValid>());
+                        buildPacket<FromServer::SendScoreResponseValid>());
                 };
                 pHandler[FromClient::RequestLeaderboard] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
                     std::string username, levelId, validator;
                     float diffMult;
-                    ssvuj::extrArray(getDecompressedPacket(mP), username,
-                        levelId, validator, diffMult);
+                    extrPacket<FromClient::RequestLeaderboard>(
+                        mP, username, levelId, validator, diffMult);
 
-                    if(!loginDB.isLoggedIn(username))
+                    if(!isValidDiffMult(diffMult))
                     {
                         HG_LO_VERBOSE("PacketHandler")
-                            << "User not logged in!\n";
+                            << "Invalid difficulty multiplier!\n";
                         mMS.send(
-                            buildCPacket<FromServer::SendLeaderboardFailed>());
+                            buildPacket<FromServer::SendLeaderboardFailed>());
                         return;
                     }
+                    auto diffKey(getDiffKey(diffMult));
 
-                    if(!scores.hasLevel(levelId))
+                    if(!loginDB.isLoggedIn(username))
                     {
+                        HG_LO_VERBOSE("PacketHandler")
+                            << "User not logged in!\n";
                         mMS.send(
-                            buildCPacket<FromServer::SendLeaderboardFailed>());
+                            buildPacket<FromServer::SendLeaderboardFailed>());
                         return;
                     }
-                    auto& l(scores.getLevel(levelId));
 
                     if(Online::getValidators().getValidator(levelId) !=
                         validator)
@@ -443,182 +726,173 @@ namespace hg
                             << Online::getValidators().getValidator(levelId)
                             << "\n" << validator << "\n";
                         mMS.send(
-                            buildCPacket<FromServer::SendLeaderboardFailed>());
+                            buildPacket<FromServer::SendLeaderboardFailed>());
                         return;
                     }
 
-                    if(!l.hasDiffMult(diffMult))
+                    sf::Packet response;
+                    scores.withLevelIfExists(levelId, [&](LevelScoreDB& mL)
+                        {
+                            if(!mL.hasDiffKey(diffKey))
+                            {
+                                HG_LO_VERBOSE("PacketHandler")
+                                    << "No difficulty multiplier table!\n";
+                                return;
+                            }
+
+                            response = getLeaderboardResponse(
+                                mL, username, levelId, diffKey);
+                        });
+
+                    if(response.getDataSize() == 0)
                     {
-                        HG_LO_VERBOSE("PacketHandler")
-                            << "No difficulty multiplier table!\n";
                         mMS.send(
-                            buildCPacket<FromServer::SendLeaderboardFailed>());
+                            buildPacket<FromServer::SendLeaderboardFailed>());
                         return;
                     }
 
                     HG_LO_VERBOSE("PacketHandler")
                         << "Validator matches, sending leaderboard\n";
-
-                    const auto& sortedScores(l.getSortedScores(diffMult));
-                    ssvuj::Obj response;
-
-                    auto i(0u);
-                    for(const auto& v : ssvu::asRangeReverse(sortedScores))
-                    {
-                        auto& responseObj(ssvuj::getObj(response, "r"));
-                        auto& arrayObj(ssvuj::getObj(responseObj, i));
-
-                        ssvuj::arch(arrayObj, 0, v.second);
-                        ssvuj::arch(arrayObj, 1, v.first);
-                        ++i;
-                        if(i >
-                            ssvu::getClamped(8u, 0u,
-                                ssvu::toNum<unsigned int>(sortedScores.size())))
-                            break;
-                    }
-                    ssvuj::arch(response, "id", levelId);
-
-                    float playerScore{l.getPlayerScore(username, diffMult)};
-                    ssvuj::arch(response, "ps", playerScore);
-
-                    int playerPosition(l.getPlayerPosition(username, diffMult));
-                    ssvuj::arch(response, "pp", playerPosition);
-
-                    auto responseStr(ssvuj::getWriteToString(response));
-                    mMS.send(
-                        buildCPacket<FromServer::SendLeaderboard>(responseStr));
+                    mMS.send(response);
                 };
+
                 pHandler[FromClient::NUR_Email] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
                     ssvu::lo("PacketHandler") << "Received email packet\n";
                     HG_LO_VERBOSE("PacketHandler") << "Received email packet\n";
                     std::string username, email;
-                    ssvuj::extrArray(
-                        getDecompressedPacket(mP), username, email);
+                    extrPacket<FromClient::NUR_Email>(mP, username, email);
 
                     users.setEmail(username, email);
 
                     HG_LO_VERBOSE("PacketHandler") << "Email accepted\n";
-                    mMS.send(buildCPacket<FromServer::NUR_EmailValid>());
-                    modifiedUsers = true;
+                    mMS.send(buildPacket<FromServer::NUR_EmailValid>());
                 };
 
                 pHandler[FromClient::RequestUserStats] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
-                    std::string username{ssvuj::getExtr<std::string>(
-                        getDecompressedPacket(mP), 0)};
-                    ssvuj::Obj response;
-                    ssvuj::arch(response, users.getUser(username).stats);
-                    mMS.send(buildCPacket<FromServer::SendUserStats>(
-                        ssvuj::getWriteToString(response)));
+                    std::string username;
+                    extrPacket<FromClient::RequestUserStats>(mP, username);
+                    auto stats(users.withUser(username, [](const User& mU)
+                        {
+                            return mU.stats;
+                        }));
+
+                    mMS.send(buildPacket<FromServer::SendUserStats>(
+                        stats.minutesSpentPlaying, stats.deaths,
+                        stats.restarts, stats.trackedNames));
                 };
 
 
                 // User statistics
                 pHandler[FromClient::US_Death] = [this](
-                    ClientHandler&, sf::Packet& mP)
+                    ClientHandler&, PacketReader& mP)
                 {
-                    getUserFromPacket(mP).stats.deaths += 1;
-                    modifiedUsers = true;
+                    modifyUserFromPacket<FromClient::US_Death>(
+                        mP, [](User& mU)
+                        {
+                            mU.stats.deaths += 1;
+                        });
                 };
                 pHandler[FromClient::US_Restart] = [this](
-                    ClientHandler&, sf::Packet& mP)
+                    ClientHandler&, PacketReader& mP)
                 {
-                    getUserFromPacket(mP).stats.restarts += 1;
-                    modifiedUsers = true;
+                    modifyUserFromPacket<FromClient::US_Restart>(
+                        mP, [](User& mU)
+                        {
+                            mU.stats.restarts += 1;
+                        });
                 };
                 pHandler[FromClient::US_MinutePlayed] = [this](
-                    ClientHandler&, sf::Packet& mP)
+                    ClientHandler&, PacketReader& mP)
                 {
-                    getUserFromPacket(mP).stats.minutesSpentPlaying += 1;
-                    modifiedUsers = true;
+                    modifyUserFromPacket<FromClient::US_MinutePlayed>(
+                        mP, [](User& mU)
+                        {
+                            mU.stats.minutesSpentPlaying += 1;
+                        });
                 };
                 pHandler[FromClient::US_ClearFriends] = [this](
-                    ClientHandler&, sf::Packet& mP)
+                    ClientHandler&, PacketReader& mP)
                 {
-                    getUserFromPacket(mP).stats.trackedNames.clear();
-                    modifiedUsers = true;
+                    modifyUserFromPacket<FromClient::US_ClearFriends>(
+                        mP, [](User& mU)
+                        {
+                            mU.stats.trackedNames.clear();
+                        });
                 };
 
                 pHandler[FromClient::US_AddFriend] = [this](
-                    ClientHandler&, sf::Packet& mP)
+                    ClientHandler&, PacketReader& mP)
                 {
                     std::string username, friendUsername;
-                    ssvuj::extrArray(
-                        getDecompressedPacket(mP), username, friendUsername);
+                    extrPacket<FromClient::US_AddFriend>(
+                        mP, username, friendUsername);
 
                     if(username == friendUsername ||
                         !users.hasUser(friendUsername))
                         return;
 
-                    auto& tn(users.getUser(username).stats.trackedNames);
-                    if(ssvu::contains(tn, friendUsername)) return;
-                    tn.emplace_back(friendUsername);
-                    modifiedUsers = true;
+                    users.modifyUser(username, [&](User& mU)
+                        {
+                            auto& tn(mU.stats.trackedNames);
+                            if(!ssvu::contains(tn, friendUsername))
+                                tn.emplace_back(friendUsername);
+                        });
                 };
 
                 pHandler[FromClient::RequestFriendsScores] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
                     std::string username, levelId;
                     float diffMult;
-                    ssvuj::extrArray(
-                        getDecompressedPacket(mP), username, levelId, diffMult);
-
-                    if(!scores.hasLevel(levelId)) return;
-                    const auto& l(scores.getLevel(levelId));
-
-                    ssvuj::Obj response;
+                    extrPacket<FromClient::RequestFriendsScores>(
+                        mP, username, levelId, diffMult);
+                    if(!isValidDiffMult(diffMult)) return;
+                    auto diffKey(getDiffKey(diffMult));
+
+                    // Copied so that both databases are never locked at
+                    // the same time.
+                    auto trackedNames(
+                        users.withUser(username, [](const User& mU)
+                            {
+                                return mU.stats.trackedNames;
+                            }));
 
-                    for(const auto& n :
-                        users.getUser(username).stats.trackedNames)
-                    {
-                        const auto& score(l.getPlayerScore(n, diffMult));
-                        if(score == -1.f) continue;
-                        ssvuj::arch(response[n], 0, score);
-                        ssvuj::arch(
-                            response[n], 1, l.getPlayerPosition(n, diffMult));
-                    }
+                    FriendScores response;
+                    bool found{scores.withLevelIfExists(
+                        levelId, [&](const LevelScoreDB& mL)
+                        {
+                            for(const auto& n : trackedNames)
+                            {
+                                const auto& score(
+                                    mL.getPlayerScore(n, diffKey));
+                                if(score == -1.f) continue;
+                                response.emplace_back(n, score,
+                                    mL.getPlayerPosition(n, diffKey));
+                            }
+                        })};
+                    if(!found) return;
 
-                    mMS.send(buildCPacket<FromServer::SendFriendsScores>(
-                        ssvuj::getWriteToString(response)));
+                    mMS.send(
+                        buildPacket<FromServer::SendFriendsScores>(response));
                 };
 
                 pHandler[FromClient::Logout] = [this](
-                    ClientHandler& mMS, sf::Packet& mP)
+                    ClientHandler& mMS, PacketReader& mP)
                 {
-                    std::string username{ssvuj::getExtr<std::string>(
-                        getDecompressedPacket(mP), 0)};
+                    std::string username;
+                    extrPacket<FromClient::Logout>(mP, username);
                     if(!loginDB.isLoggedIn(username)) return;
                     loginDB.logout(username);
                     HG_LO_VERBOSE("PacketHandler") << username
                                                    << " logged out\n";
-                    mMS.send(buildCPacket<FromServer::SendLogoutValid>());
+                    mMS.send(buildPacket<FromServer::SendLogoutValid>());
                 };
             }
-            ~OHServer()
-            {
-                saveIfNeeded();
-                ssvu::lo() << "OHServer destroyed\n";
-            }
-
-            inline void saveIfNeeded()
-            {
-                if(modifiedScores)
-                {
-                    saveScores();
-                    modifiedScores = false;
-                    HG_LO_VERBOSE("saveIfNeeded") << "Saving scores...\n";
-                }
-                if(modifiedUsers)
-                {
-                    saveUsers();
-                    modifiedUsers = false;
-                    HG_LO_VERBOSE("saveIfNeeded") << "Saving users...\n";
-                }
-            }
+            ~OHServer() { ssvu::lo() << "OHServer destroyed\n"; }
 
             inline void start()
             {
@@ -657,7 +931,7 @@ namespace hg
                         while(server.isRunning())
                         {
                             std::this_thread::sleep_for(5s);
-                            saveIfNeeded();
+                            storage->compact();
                         }
                     });
 
@@ -680,9 +954,9 @@ namespace hg
                     cmd.setDesc("Stops the server.");
                     cmd += [this]
                     {
-                        ssvu::lo() << "Stopping server... saving if needed\n";
-                        saveIfNeeded();
+                        ssvu::lo() << "Stopping server... saving\n";
                         server.stop();
+                        storage->compact();
                     };
                 }
 
@@ -718,8 +992,8 @@ namespace hg
                     {
                         if(arg.get() == "users")
                         {
-                            for(const auto& u : users.getUsers())
-                                ssvu::lo() << u.first << "\n";
+                            for(const auto& u : users.getUsernames())
+                                ssvu::lo() << u << "\n";
                         }
                         else if(arg.get() == "logins")
                         {
@@ -7,6 +7,7 @@
 
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Online/Compression.hpp"
+#include "SSVOpenHexagon/Online/Protocol.hpp"
 #include "SSVOpenHexagon/Online/Utils.hpp"
 
 namespace hg
@@ -63,6 +64,7 @@ namespace hg
         };
 
         void initializeValidators(HGAssets& mAssets);
+        void refreshValidator(HGAssets& mAssets, const std::string& mLevelId);
         void initializeClient();
         void setCurrentGtm(GlobalThreadManager&);
 
@@ -127,42 +129,6 @@ namespace hg
 
         bool getNewUserReg();
 
-        // Client to server
-        enum FromClient : unsigned int
-        {
-            Ping = 0,
-            Login,
-            RequestInfo,
-            SendScore,
-            RequestLeaderboard,
-            RequestUserStats,
-            US_Death,
-            US_MinutePlayed,
-            US_Restart,
-            US_AddFriend,
-            US_ClearFriends,
-            RequestFriendsScores,
-            Logout,
-            NUR_Email
-        };
-
-        // Server to client
-        enum FromServer : unsigned int
-        {
-            LoginResponseValid = 0,
-            LoginResponseInvalid,
-            RequestInfoResponse,
-            SendLeaderboard,
-            SendScoreResponseValid,
-            SendScoreResponseInvalid,
-            SendLeaderboardFailed,
-            SendUserStats,
-            SendUserStatsFailed,
-            SendFriendsScores,
-            SendLogoutValid,
-            NUR_EmailValid
-        };
-
         const sf::IpAddress& getCurrentIpAddress();
         unsigned short getCurrentPort();
     }
@@ -6,6 +6,7 @@
 #define HG_ONLINE_PACKETHANDLER
 
 #include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Online/Protocol.hpp"
 #include "SSVOpenHexagon/Online/Utils.hpp"
 
 namespace hg
@@ -16,7 +17,7 @@ namespace hg
         class PacketHandler
         {
         private:
-            using HandlerFunc = ssvu::Func<void(T&, sf::Packet&)>;
+            using HandlerFunc = ssvu::Func<void(T&, PacketReader&)>;
             std::unordered_map<unsigned int, HandlerFunc> funcs;
 
         public:
@@ -26,7 +27,16 @@ namespace hg
 
                 try
                 {
-                    mPacket >> type;
+                    PacketReader reader{
+                        static_cast<const char*>(mPacket.getData()),
+                        mPacket.getDataSize()};
+                    if(!reader.openPacket(type))
+                    {
+                        HG_LO_VERBOSE("PacketHandler")
+                            << "Dropping packet of another protocol version"
+                            << std::endl;
+                        return;
+                    }
 
                     auto itr(funcs.find(type));
                     if(itr == std::end(funcs))
@@ -37,7 +47,7 @@ namespace hg
                         return;
                     }
 
-                    itr->second(mCaller, mPacket);
+                    itr->second(mCaller, reader);
                 }
                 catch(std::exception& mEx)
                 {
@@ -0,0 +1,366 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_PROTOCOL
+#define HG_ONLINE_PROTOCOL
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Bumped whenever the tables below or the encoding change. Packets
+        // of other versions are dropped.
+        constexpr unsigned int protocolVersion{1};
+
+        // Payloads of at least this many bytes are compressed.
+        constexpr SizeT compressionThreshold{256};
+
+        // Top of a leaderboard: players and scores, best first.
+        using LeaderboardEntries = std::vector<std::pair<std::string, float>>;
+
+        // Tracked players of a user: name, score and position.
+        using FriendScores =
+            std::vector<std::tuple<std::string, float, std::int32_t>>;
+
+        // Data written by `PacketWriter::getPayload`, sent as a field of
+        // another packet. It is already compressed if worth it, so the
+        // payload holding it never is.
+        struct Payload
+        {
+            std::string data;
+
+            Payload() = default;
+            inline Payload(std::string mData) : data{std::move(mData)} {}
+        };
+    }
+}
+
+// Every packet, with the types of its fields in order. The packet enums
+// and the schemas that `buildPacket` and `extrPacket` check against are
+// generated from these tables.
+#define HG_FROM_CLIENT_PACKETS(X)                                       \
+    X(Ping, ())                                                         \
+    X(Login, (std::string, std::string))                                \
+    X(RequestInfo, ())                                                  \
+    X(SendScore, (std::string, std::string, std::string, float, float)) \
+    X(RequestLeaderboard, (std::string, std::string, std::string, float)) \
+    X(RequestUserStats, (std::string))                                  \
+    X(US_Death, (std::string))                                          \
+    X(US_MinutePlayed, (std::string))                                   \
+    X(US_Restart, (std::string))                                        \
+    X(US_AddFriend, (std::string, std::string))                         \
+    X(US_ClearFriends, (std::string))                                   \
+    X(RequestFriendsScores, (std::string, std::string, float))          \
+    X(Logout, (std::string))                                            \
+    X(NUR_Email, (std::string, std::string))
+
+// `SendLeaderboard` starts with a `Payload` holding the level id and its
+// `LeaderboardEntries`, which is shared by every player asking for it.
+#define HG_FROM_SERVER_PACKETS(X)                                       \
+    X(LoginResponseValid, (bool))                                       \
+    X(LoginResponseInvalid, ())                                         \
+    X(RequestInfoResponse, (float, std::string))                        \
+    X(SendLeaderboard, (Payload, float, std::int32_t))                  \
+    X(SendScoreResponseValid, ())                                       \
+    X(SendScoreResponseInvalid, ())                                     \
+    X(SendLeaderboardFailed, ())                                        \
+    X(SendUserStats, (std::uint32_t, std::uint32_t, std::uint32_t,      \
+                         std::vector<std::string>))                     \
+    X(SendUserStatsFailed, ())                                          \
+    X(SendFriendsScores, (FriendScores))                                \
+    X(SendLogoutValid, ())                                              \
+    X(NUR_EmailValid, ())
+
+#define HG_PACKET_FIELDS(...) __VA_ARGS__
+#define HG_PACKET_ENUMERATOR(mName, mFields) mName,
+
+namespace hg
+{
+    namespace Online
+    {
+        // Client to server
+        enum FromClient : unsigned int
+        {
+            HG_FROM_CLIENT_PACKETS(HG_PACKET_ENUMERATOR)
+        };
+
+        // Server to client
+        enum FromServer : unsigned int
+        {
+            HG_FROM_SERVER_PACKETS(HG_PACKET_ENUMERATOR)
+        };
+
+        template <FromClient TType>
+        struct ClientPacket;
+        template <FromServer TType>
+        struct ServerPacket;
+
+#define HG_CLIENT_PACKET_SCHEMA(mName, mFields)            \
+    template <>                                            \
+    struct ClientPacket<FromClient::mName>                 \
+    {                                                      \
+        using Fields = std::tuple<HG_PACKET_FIELDS mFields>; \
+    };
+#define HG_SERVER_PACKET_SCHEMA(mName, mFields)            \
+    template <>                                            \
+    struct ServerPacket<FromServer::mName>                 \
+    {                                                      \
+        using Fields = std::tuple<HG_PACKET_FIELDS mFields>; \
+    };
+
+        HG_FROM_CLIENT_PACKETS(HG_CLIENT_PACKET_SCHEMA)
+        HG_FROM_SERVER_PACKETS(HG_SERVER_PACKET_SCHEMA)
+
+#undef HG_SERVER_PACKET_SCHEMA
+#undef HG_CLIENT_PACKET_SCHEMA
+
+        // Encodes values compactly: integers as varints (zigzag for signed
+        // ones), floats as their 4 bytes, and strings and vectors prefixed
+        // with their size.
+        class PacketWriter
+        {
+        private:
+            std::string data;
+            bool holdsPayload{false};
+
+            void writeVarint(std::uint64_t mValue);
+
+        public:
+            template <typename T>
+            inline std::enable_if_t<std::is_unsigned<T>::value, PacketWriter&>
+            operator<<(T mValue)
+            {
+                writeVarint(mValue);
+                return *this;
+            }
+            template <typename T>
+            inline std::enable_if_t<std::is_signed<T>::value &&
+                                        std::is_integral<T>::value,
+                PacketWriter&>
+            operator<<(T mValue)
+            {
+                const std::int64_t v(mValue);
+                writeVarint((std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63));
+                return *this;
+            }
+
+            PacketWriter& operator<<(bool mValue);
+            PacketWriter& operator<<(float mValue);
+            PacketWriter& operator<<(const std::string& mValue);
+            PacketWriter& operator<<(const Payload& mValue);
+            PacketWriter& operator<<(const char*) = delete;
+
+            template <typename T>
+            inline PacketWriter& operator<<(const std::vector<T>& mValue)
+            {
+                *this << mValue.size();
+                for(const auto& v : mValue) *this << v;
+                return *this;
+            }
+            template <typename T1, typename T2>
+            inline PacketWriter& operator<<(const std::pair<T1, T2>& mValue)
+            {
+                return *this << mValue.first << mValue.second;
+            }
+            template <typename... Ts>
+            inline PacketWriter& operator<<(const std::tuple<Ts...>& mValue)
+            {
+                writeTuple(mValue, std::index_sequence_for<Ts...>{});
+                return *this;
+            }
+            template <typename TTuple, SizeT... TIs>
+            inline void writeTuple(
+                const TTuple& mValue, std::index_sequence<TIs...>)
+            {
+                using Swallow = int[];
+                (void)Swallow{0, (*this << std::get<TIs>(mValue), 0)...};
+            }
+
+            // Writes `mValue` as a `T`, converting it if needed.
+            template <typename T>
+            inline PacketWriter& write(const T& mValue)
+            {
+                return *this << mValue;
+            }
+
+            inline const std::string& getData() const { return data; }
+
+            // Empties the data, keeping its memory.
+            inline void clear()
+            {
+                data.clear();
+                holdsPayload = false;
+            }
+
+            // The data, preceded by whether it is compressed.
+            void writePayload(PacketWriter& mOut) const;
+            std::string getPayload() const;
+        };
+
+        // Decodes what `PacketWriter` encodes, throwing
+        // `std::runtime_error` if the data is malformed.
+        class PacketReader
+        {
+        private:
+            const char* ptr;
+            const char* end;
+
+            // Holds the data of a compressed payload.
+            std::string inflated;
+
+            void require(SizeT mSize);
+            std::uint64_t readVarint();
+
+        public:
+            inline PacketReader(const char* mData, SizeT mSize)
+                : ptr{mData}, end{mData + mSize}
+            {
+            }
+
+            PacketReader(const PacketReader&) = delete;
+            PacketReader& operator=(const PacketReader&) = delete;
+
+            template <typename T>
+            inline std::enable_if_t<std::is_unsigned<T>::value, PacketReader&>
+            operator>>(T& mValue)
+            {
+                const auto v(readVarint());
+                if(v > std::numeric_limits<T>::max())
+                    throw std::runtime_error("packet value out of range");
+
+                mValue = T(v);
+                return *this;
+            }
+            template <typename T>
+            inline std::enable_if_t<std::is_signed<T>::value &&
+                                        std::is_integral<T>::value,
+                PacketReader&>
+            operator>>(T& mValue)
+            {
+                const auto u(readVarint());
+                const auto v(std::int64_t(u >> 1) ^ -std::int64_t(u & 1));
+                if(v < std::numeric_limits<T>::min() ||
+                    v > std::numeric_limits<T>::max())
+                    throw std::runtime_error("packet value out of range");
+
+                mValue = T(v);
+                return *this;
+            }
+
+            PacketReader& operator>>(bool& mValue);
+            PacketReader& operator>>(float& mValue);
+            PacketReader& operator>>(std::string& mValue);
+            PacketReader& operator>>(Payload& mValue);
+
+            template <typename T>
+            inline PacketReader& operator>>(std::vector<T>& mValue)
+            {
+                SizeT size;
+                *this >> size;
+
+                // Every element takes at least a byte.
+                require(size);
+                mValue.resize(size);
+                for(auto& v : mValue) *this >> v;
+                return *this;
+            }
+            template <typename T1, typename T2>
+            inline PacketReader& operator>>(std::pair<T1, T2>& mValue)
+            {
+                return *this >> mValue.first >> mValue.second;
+            }
+            template <typename... Ts>
+            inline PacketReader& operator>>(std::tuple<Ts...>& mValue)
+            {
+                readTuple(mValue, std::index_sequence_for<Ts...>{});
+                return *this;
+            }
+            template <typename TTuple, SizeT... TIs>
+            inline void readTuple(TTuple& mValue, std::index_sequence<TIs...>)
+            {
+                using Swallow = int[];
+                (void)Swallow{0, (*this >> std::get<TIs>(mValue), 0)...};
+            }
+
+            // Reads the rest as a payload written by `getPayload`.
+            void openPayload();
+
+            // Reads the header of a packet built by `buildPacket`, then
+            // opens its payload. Returns false, having read nothing else,
+            // if it was built for another protocol version.
+            bool openPacket(unsigned int& mType);
+        };
+
+        namespace Impl
+        {
+            sf::Packet buildPacket(unsigned int mType, const PacketWriter& mW);
+
+            template <typename TFields, SizeT... TIs, typename... TArgs>
+            inline sf::Packet buildPacket(unsigned int mType,
+                std::index_sequence<TIs...>, const TArgs&... mArgs)
+            {
+                static_assert(sizeof...(TArgs) ==
+                                  std::tuple_size<TFields>::value,
+                    "Wrong number of packet fields");
+
+                PacketWriter w;
+                using Swallow = int[];
+                (void)Swallow{0,
+                    (w.write<std::tuple_element_t<TIs, TFields>>(mArgs),
+                        0)...};
+
+                return buildPacket(mType, w);
+            }
+
+            template <typename TFields, typename... TArgs>
+            inline void extrPacket(PacketReader& mR, TArgs&... mArgs)
+            {
+                static_assert(
+                    std::is_same<std::tuple<TArgs...>, TFields>::value,
+                    "Packet fields do not match the schema");
+
+                using Swallow = int[];
+                (void)Swallow{0, (mR >> mArgs, 0)...};
+            }
+        }
+
+        template <FromClient TType, typename... TArgs>
+        inline sf::Packet buildPacket(const TArgs&... mArgs)
+        {
+            return Impl::buildPacket<typename ClientPacket<TType>::Fields>(
+                TType, std::index_sequence_for<TArgs...>{}, mArgs...);
+        }
+        template <FromServer TType, typename... TArgs>
+        inline sf::Packet buildPacket(const TArgs&... mArgs)
+        {
+            return Impl::buildPacket<typename ServerPacket<TType>::Fields>(
+                TType, std::index_sequence_for<TArgs...>{}, mArgs...);
+        }
+
+        template <FromClient TType, typename... TArgs>
+        inline void extrPacket(PacketReader& mR, TArgs&... mArgs)
+        {
+            Impl::extrPacket<typename ClientPacket<TType>::Fields>(
+                mR, mArgs...);
+        }
+        template <FromServer TType, typename... TArgs>
+        inline void extrPacket(PacketReader& mR, TArgs&... mArgs)
+        {
+            Impl::extrPacket<typename ServerPacket<TType>::Fields>(
+                mR, mArgs...);
+        }
+    }
+}
+
+#endif
@@ -5,68 +5,77 @@
 #ifndef HG_ONLINE_SERVER
 #define HG_ONLINE_SERVER
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <chrono>
 #include <thread>
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Global/Config.hpp"
 #include "SSVOpenHexagon/Online/ClientHandler.hpp"
+#include "SSVOpenHexagon/Online/PacketHandler.hpp"
 #include "SSVOpenHexagon/Online/Utils.hpp"
 
 namespace hg
 {
     namespace Online
     {
+        // Serves every connection from a fixed number of I/O threads. Each
+        // thread waits on its own clients and on the shared listener, so
+        // packets are read as soon as they arrive and a new client stays
+        // on the thread that accepted it.
+        // Packets are handled by a fixed number of worker threads. Every
+        // client is bound to one worker, which handles its packets, then
+        // its disconnection, in the order they arrived.
         class Server
         {
         private:
-            bool running{false};
-            PacketHandler<ClientHandler>& packetHandler;
-            sf::TcpListener listener;
-            ssvu::VecUPtr<ClientHandler> clientHandlers;
-            std::future<void> updateFuture;
+            using ClientPtr = std::shared_ptr<ClientHandler>;
 
-            inline void updateImpl()
+            struct Task
             {
-                while(running)
-                {
-                    std::this_thread::sleep_for(50ms);
-                    update();
-                }
-            }
+                ClientPtr client;
+                sf::Packet packet;
+                bool disconnect{false};
+            };
 
-            inline void update()
+            struct IOThread
             {
-                bool foundNonBusy{false};
+                sf::SocketSelector selector;
+                std::vector<ClientPtr> clientHandlers;
+                std::vector<sf::Packet> received;
+                std::chrono::steady_clock::time_point lastTimeoutCheck;
+                std::future<void> future;
+            };
 
-                for(auto i(0u); true; ++i)
-                {
-                    if(i >= clientHandlers.size())
-                    {
-                        if(foundNonBusy) return;
+            struct Worker
+            {
+                std::mutex mutex;
+                std::condition_variable cv;
+                std::deque<Task> tasks;
+                std::future<void> future;
+            };
 
-                        HG_LO_VERBOSE("Server")
-                            << "Creating new client handlers\n";
-                        for(auto k(0u); k < 10; ++k)
-                            ssvu::getEmplaceUPtr<ClientHandler>(
-                                clientHandlers, packetHandler);
-                    }
+            std::atomic<bool> running{false}, workersRunning{false};
+            PacketHandler<ClientHandler>& packetHandler;
+            sf::TcpListener listener;
+            ssvu::VecUPtr<IOThread> ioThreads;
+            ssvu::VecUPtr<Worker> workers;
 
-                    auto& c(clientHandlers[i]);
+            void dispatch(const ClientPtr& mClient, sf::Packet mPacket,
+                bool mDisconnect = false);
+            void removeClient(IOThread& mIO, const ClientPtr& mClient);
 
-                    if(c->isBusy()) continue;
-                    foundNonBusy = true;
-
-                    if(!c->tryAccept(listener)) continue;
-                    onClientAccepted(*c.get());
-                    c->refreshTimeout();
-                    HG_LO_VERBOSE("Server") << "Accepted client ("
-                                            << c->getUid() << ")\n";
-                    return;
-                }
-            }
+            void acceptClients(IOThread& mIO);
+            void updateClients(IOThread& mIO);
+            void runIOThread(IOThread& mIO);
+            void runWorker(Worker& mWorker);
 
         public:
+            // Called on the I/O thread that accepted the client.
             ssvu::Delegate<void(ClientHandler&)> onClientAccepted;
 
             inline Server(PacketHandler<ClientHandler>& mPacketHandler)
@@ -74,30 +83,17 @@ namespace hg
             {
                 listener.setBlocking(false);
             }
-            inline ~Server() { running = false; }
+            inline ~Server() { stop(); }
 
-            inline void start(unsigned short mPort)
-            {
-                if(listener.listen(mPort) != sf::Socket::Done)
-                {
-                    ssvu::lo("Server") << "Error initalizing listener\n";
-                    return;
-                }
-                else
-                    ssvu::lo("Server") << "Listener initialized\n";
+            // `mIOThreadCount` defaults to the number of cores, up to 4, and
+            // `mWorkerCount` to the number of cores.
+            void start(unsigned short mPort, SizeT mIOThreadCount = 0,
+                SizeT mWorkerCount = 0);
+
+            // Waits for the I/O threads, which disconnect their clients,
+            // then for the workers to handle everything they were given.
+            void stop();
 
-                running = true;
-                updateFuture = std::async(std::launch::async, [this]
-                    {
-                        updateImpl();
-                    });
-            }
-            inline void stop()
-            {
-                for(auto& ch : clientHandlers) ch->stop();
-                running = false;
-                listener.close();
-            }
             inline bool isRunning() const { return running; }
         };
     }
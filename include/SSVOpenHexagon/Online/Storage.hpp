@@ -0,0 +1,56 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_ONLINE_STORAGE
+#define HG_ONLINE_STORAGE
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    namespace Online
+    {
+        // Key-value store holding the server's databases. Keys are ordered
+        // bytewise, so that the records sharing a prefix can be scanned
+        // together. Every function is thread-safe, and a record is durable
+        // once `put` returns.
+        class Storage
+        {
+        public:
+            using KeyFn = ssvu::Func<void(const std::string&)>;
+            using RecordFn =
+                ssvu::Func<void(const std::string&, const std::string&)>;
+
+            virtual ~Storage() {}
+
+            virtual bool has(const std::string& mKey) = 0;
+
+            // Returns false if there is no record for `mKey`.
+            virtual bool get(const std::string& mKey, std::string& mValue) = 0;
+            virtual void put(
+                const std::string& mKey, const std::string& mValue) = 0;
+
+            // Calls `mFn` for every record whose key starts with `mPrefix`,
+            // in key order. `mFn` must not use the storage.
+            virtual void scanKeys(
+                const std::string& mPrefix, const KeyFn& mFn) = 0;
+            virtual void scan(
+                const std::string& mPrefix, const RecordFn& mFn) = 0;
+
+            virtual bool isEmpty() = 0;
+
+            // Reclaims the space taken by replaced records, if worth it.
+            virtual void compact() = 0;
+        };
+
+        // `mEngine` is "memory" for `MemoryStorage` or "log" for
+        // `LogStorage`. Their files are named after `mPath`. Throws
+        // `std::runtime_error` if existing files cannot be read, rather
+        // than starting without their records.
+        UPtr<Storage> createStorage(
+            const std::string& mEngine, const std::string& mPath);
+    }
+}
+
+#endif
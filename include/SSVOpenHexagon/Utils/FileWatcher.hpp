@@ -0,0 +1,41 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_FILEWATCHER
+#define HG_UTILS_FILEWATCHER
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Non-blocking watcher for files written inside a set of folders.
+    // Backed by inotify on Linux; on other platforms it never reports changes.
+    class FileWatcher
+    {
+    private:
+        int fd{-1};
+        std::unordered_map<int, std::string> watchedFolders;
+        std::vector<std::string> changedFiles;
+
+        void watchFolderImpl(const std::string& mPath);
+
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        inline bool isEnabled() const noexcept { return fd != -1; }
+
+        // Watches `mPath` and all of its subfolders.
+        void watchFolder(const Path& mPath);
+
+        // Returns the files (re)written since the last call, without
+        // duplicates. Never blocks.
+        const std::vector<std::string>& poll();
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_JSONCACHE
+#define HG_UTILS_JSONCACHE
+
+#include <mutex>
+#include <unordered_set>
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Utils/MappedFile.hpp"
+
+namespace hg
+{
+    // Binary cache of parsed JSON files, used to skip JsonCpp's text parser
+    // on warm starts. Every file is stored as a flat, length-prefixed
+    // encoding of its value tree, keyed by path and validated by the
+    // file's modification time and size. The cache file is memory-mapped
+    // where supported and is only valid on the machine that wrote it.
+    class JsonCache
+    {
+    private:
+        struct Entry
+        {
+            std::int64_t mtime;
+            std::uint64_t size;
+            const char* data;
+            SizeT dataSize;
+        };
+
+        struct NewEntry
+        {
+            std::int64_t mtime;
+            std::uint64_t size;
+            std::string data;
+        };
+
+        Path cachePath;
+        MappedFile file;
+
+        // `entries` is read-only after construction; everything else is
+        // guarded by `mutex`.
+        std::unordered_map<std::string, Entry> entries;
+        std::unordered_map<std::string, NewEntry> newEntries;
+        std::unordered_set<std::string> usedEntries;
+        std::mutex mutex;
+        bool dirty{false};
+
+        void load();
+
+    public:
+        JsonCache(const Path& mCachePath);
+
+        JsonCache(const JsonCache&) = delete;
+        JsonCache& operator=(const JsonCache&) = delete;
+
+        // Thread-safe replacement for `ssvuj::getFromFile`. Also reads
+        // files of mounted pack archives (see `VFS`).
+        ssvuj::Obj getFromFile(const Path& mPath);
+
+        // Also adds the size of the file to `mParsedBytes` if it had to
+        // be parsed, rather than read from the cache.
+        ssvuj::Obj getFromFile(const Path& mPath, std::uint64_t& mParsedBytes);
+
+        // Rewrites the cache file if entries were added or went stale.
+        // Unused entries whose files are unchanged are kept, so processes
+        // reading different files can share the cache.
+        void save();
+    };
+}
+
+#endif
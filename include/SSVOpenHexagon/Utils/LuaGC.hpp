@@ -0,0 +1,41 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_LUAGC
+#define HG_UTILS_LUAGC
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Takes a level's Lua state off the automatic garbage collection
+    // schedule, so that collection only happens in explicit steps run at
+    // idle points of the frame, and keeps track of its memory usage.
+    class LuaGC
+    {
+    private:
+        Lua::LuaContext* lua{nullptr};
+        float currentKB{0.f}, peakKB{0.f};
+
+    public:
+        // Installs the helper functions in `mLua` and stops the automatic
+        // collector, which `collect` and `step` stop again afterwards.
+        // Must be called again whenever the context is replaced.
+        void attach(Lua::LuaContext& mLua);
+
+        // Runs a full collection, e.g. after loading a level.
+        void collect();
+
+        // Runs an incremental step that covers at least the memory
+        // allocated since the previous step, and no less than `mMinKB`.
+        void step(float mMinKB);
+
+        inline float getCurrentKB() const noexcept { return currentKB; }
+
+        // Highest usage seen since `attach`, sampled before every step.
+        inline float getPeakKB() const noexcept { return peakKB; }
+    };
+}
+
+#endif
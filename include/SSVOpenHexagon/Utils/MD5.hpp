@@ -0,0 +1,38 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_MD5
+#define HG_UTILS_MD5
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Incremental MD5 (RFC 1321). Feeding the same bytes in any number of
+    // `update` calls gives the same digest as hashing them in one go.
+    class MD5
+    {
+    private:
+        std::uint32_t state[4];
+        std::uint64_t byteCount{0};
+        unsigned char block[64];
+
+        void transform(const unsigned char* mBlock);
+
+    public:
+        MD5();
+
+        void update(const char* mData, SizeT mSize);
+        inline void update(const std::string& mStr)
+        {
+            update(mStr.data(), mStr.size());
+        }
+
+        // Finalizes the hash and returns it as 32 lowercase hex digits.
+        // The object must not be updated afterwards.
+        std::string getHexDigest();
+    };
+}
+
+#endif
@@ -0,0 +1,38 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_MAPPEDFILE
+#define HG_UTILS_MAPPEDFILE
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Read-only view of a whole file. The file is memory-mapped where
+    // supported, and read into memory otherwise.
+    class MappedFile
+    {
+    private:
+        const char* data{nullptr};
+        SizeT size{0};
+        std::string buffer;
+
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Returns false if the file cannot be read or is empty.
+        bool open(const std::string& mPath);
+        void close();
+
+        inline bool isOpen() const noexcept { return data != nullptr; }
+        inline const char* getData() const noexcept { return data; }
+        inline SizeT getSize() const noexcept { return size; }
+    };
+}
+
+#endif
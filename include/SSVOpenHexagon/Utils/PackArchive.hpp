@@ -0,0 +1,53 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_PACKARCHIVE
+#define HG_UTILS_PACKARCHIVE
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Utils/MappedFile.hpp"
+
+namespace hg
+{
+    struct FileView
+    {
+        const char* data;
+        SizeT size;
+    };
+
+    // Read-only archive of a pack folder (`*.ohpack`), memory-mapped so
+    // that its files are read straight from the mapping. Layout:
+    //   "OHPK", u32 version, u32 file count,
+    //   per file: u32 path length, path, u64 offset, u64 size,
+    //   file contents.
+    // Paths are relative to the pack folder; offsets to the archive start.
+    class PackArchive
+    {
+    private:
+        MappedFile file;
+        std::int64_t mtime{0};
+        std::map<std::string, FileView> files;
+
+    public:
+        // Throws `std::runtime_error` if the archive cannot be read.
+        PackArchive(const Path& mPath);
+
+        PackArchive(const PackArchive&) = delete;
+        PackArchive& operator=(const PackArchive&) = delete;
+
+        // Returns `nullptr` if there is no file named `mName`.
+        const FileView* find(const std::string& mName) const;
+
+        // Names of the files whose name starts with `mPrefix`, sorted.
+        std::vector<std::string> getFileNames(const std::string& mPrefix) const;
+
+        inline std::int64_t getMtime() const noexcept { return mtime; }
+
+        // Archives every file inside `mFolder` into `mPath`.
+        // Throws `std::runtime_error` on failure.
+        static void create(const Path& mFolder, const Path& mPath);
+    };
+}
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_SOUNDPOOL
+#define HG_UTILS_SOUNDPOOL
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Fixed set of voices, allocated once, used to play sound effects.
+    // When every voice is busy, the lowest-priority one (oldest first) is
+    // stolen, unless it outranks the new sound, which is then dropped.
+    class SoundPool
+    {
+    public:
+        // `Override` restarts a voice already playing the same buffer,
+        // `Abort` leaves it playing and drops the new sound.
+        using Mode = ssvs::SoundPlayer::Mode;
+
+        enum class Priority : std::uint8_t
+        {
+            Low,
+            Normal,
+            High
+        };
+
+    private:
+        struct Voice
+        {
+            sf::Sound sound;
+            Priority priority{Priority::Low};
+            std::uint64_t startedAt{0};
+        };
+
+        std::vector<Voice> voices;
+        std::uint64_t playCount{0};
+
+        static bool isBusy(const Voice& mVoice);
+        Voice* findVoice(const sf::SoundBuffer& mBuffer);
+        Voice* findFreeVoice(Priority mPriority);
+
+    public:
+        explicit SoundPool(SizeT mVoiceCount);
+
+        void play(sf::SoundBuffer& mBuffer, Mode mMode = Mode::Override,
+            Priority mPriority = Priority::Normal);
+        void stop();
+        void setVolume(float mVolume);
+    };
+}
+
+#endif
@@ -0,0 +1,65 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_STARTUPREPORT
+#define HG_UTILS_STARTUPREPORT
+
+#include <chrono>
+#include "SSVOpenHexagon/Global/Common.hpp"
+
+namespace hg
+{
+    // Wall-clock time and bytes read by each startup phase, optionally
+    // broken down by pack, saved as JSON to track startup regressions.
+    // Every function is thread-safe. Per-pack phases may run in parallel,
+    // so their totals are the sum of the time spent on every pack.
+    namespace StartupReport
+    {
+        void add(const std::string& mPhase, const std::string& mPack,
+            float mSeconds, std::uint64_t mBytes);
+        void addBytes(const std::string& mPhase, const std::string& mPack,
+            std::uint64_t mBytes);
+
+        // Sum of the sizes of `mFiles`.
+        std::uint64_t getBytes(const std::vector<Path>& mFiles);
+
+        void save(const Path& mPath);
+
+        // Times its own lifetime, or until `finish`, as phase `mPhase` of
+        // pack `mPack` (none if empty).
+        class Scope
+        {
+        private:
+            std::string phase, pack;
+            std::chrono::steady_clock::time_point start;
+            std::uint64_t bytes{0};
+            bool finished{false};
+
+        public:
+            Scope(const std::string& mPhase, const std::string& mPack = "")
+                : phase{mPhase}, pack{mPack},
+                  start{std::chrono::steady_clock::now()}
+            {
+            }
+            ~Scope() { finish(); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            inline void finish()
+            {
+                if(finished) return;
+                finished = true;
+
+                std::chrono::duration<float> elapsed{
+                    std::chrono::steady_clock::now() - start};
+                add(phase, pack, elapsed.count(), bytes);
+            }
+
+            inline void addBytes(std::uint64_t mBytes) { bytes += mBytes; }
+        };
+    }
+}
+
+#endif
@@ -8,11 +8,15 @@
 #include <string>
 #include <sstream>
 #include <set>
+#include <atomic>
+#include <future>
+#include <thread>
 #include "SSVOpenHexagon/Global/Common.hpp"
 #include "SSVOpenHexagon/Data/LevelData.hpp"
 #include "SSVOpenHexagon/Data/ProfileData.hpp"
 #include "SSVOpenHexagon/Data/MusicData.hpp"
 #include "SSVOpenHexagon/Data/StyleData.hpp"
+#include "SSVOpenHexagon/Utils/VFS.hpp"
 
 namespace hg
 {
@@ -28,6 +32,28 @@ namespace hg
             return x * x * x * (x * (x * 6 - 15) + 10);
         }
 
+        // Calls `mFn(i)` for every `i` in `[0, mCount)` on a pool of
+        // `std::async` workers sized after the hardware, and waits for all
+        // of them. `mFn` must be safe to call concurrently for different
+        // indices. If it throws, the worker stops and the exception is
+        // rethrown here.
+        template <typename TF>
+        inline void parallelFor(SizeT mCount, const TF& mFn)
+        {
+            std::atomic<SizeT> nextIdx{0};
+            auto worker([&]
+                {
+                    for(auto i(nextIdx++); i < mCount; i = nextIdx++) mFn(i);
+                });
+
+            SizeT workerCount{std::thread::hardware_concurrency()};
+            workerCount = std::max(SizeT(1), std::min(workerCount, mCount));
+            std::vector<std::future<void>> workers;
+            for(auto i(0u); i < workerCount; ++i)
+                workers.emplace_back(std::async(std::launch::async, worker));
+            for(auto& w : workers) w.get();
+        }
+
         sf::Color getColorDarkened(sf::Color mColor, float mMultiplier);
 
         MusicData loadMusicFromJson(const ssvuj::Obj& mRoot);
@@ -42,16 +68,66 @@ namespace hg
         std::set<std::string> getIncludedLuaFileNames(
             const std::string& mLuaScript);
 
+        // Takes the includes of the starting script and obtains those of
+        // every included script through `mGetIncludes(const Path&)`, which
+        // allows callers to cache them between several calls.
+        template <typename TF>
+        inline void recursiveFillIncludedLuaFileNames(
+            std::set<std::string>& mLuaScriptNames, const Path& mPackPath,
+            const std::set<std::string>& mIncludes, const TF& mGetIncludes)
+        {
+            for(const auto& name : mIncludes)
+            {
+                ssvufs::Path p{mPackPath + "/Scripts/" + name};
+
+                if(!VFS::exists(p))
+                {
+                    throw std::runtime_error(
+                        "\nCould not find script file:\n" + p.getStr() + "\n");
+                }
+
+                // Already visited: its includes are in the set as well.
+                if(!mLuaScriptNames.insert(name).second) continue;
+
+                try
+                {
+                    recursiveFillIncludedLuaFileNames(mLuaScriptNames,
+                        mPackPath, mGetIncludes(p), mGetIncludes);
+                }
+                catch(const std::runtime_error& re)
+                {
+                    std::string s;
+                    s += re.what();
+                    s += "...from...";
+                    s += p.getStr();
+                    s += "\n";
+
+                    throw std::runtime_error(s);
+                }
+            }
+        }
         void recursiveFillIncludedLuaFileNames(
             std::set<std::string>& mLuaScriptNames, const Path& mPackPath,
             const std::string& mLuaScript);
 
+        // Modification time and size of a file, used to validate caches.
+        bool getFileStamp(
+            const Path& mPath, std::int64_t& mMtime, std::uint64_t& mSize);
+
+        // Flushes the file to the disk. Does nothing on Windows.
+        bool syncFile(const std::string& mPath);
+
+        // Renames `mFrom` to `mTo`, replacing it, once `mFrom` is on the
+        // disk. Readers of `mTo`, and the file left by a crash, are either
+        // file whole, except on Windows.
+        bool replaceFile(const std::string& mFrom, const std::string& mTo);
+
         sf::Color transformHue(const sf::Color& in, float H);
 
         inline void runLuaFile(
             Lua::LuaContext& mLua, const std::string& mFileName)
         {
-            std::ifstream s{mFileName};
+            std::istringstream s{VFS::getContents(mFileName)};
             try
             {
                 mLua.executeCode(s);
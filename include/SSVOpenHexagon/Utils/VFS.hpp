@@ -0,0 +1,41 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#ifndef HG_UTILS_VFS
+#define HG_UTILS_VFS
+
+#include "SSVOpenHexagon/Global/Common.hpp"
+#include "SSVOpenHexagon/Utils/PackArchive.hpp"
+
+namespace hg
+{
+    // File access covering both plain files and mounted pack archives.
+    // Once "Packs/foo.ohpack" is mounted at "Packs/foo/", the path
+    // "Packs/foo/Levels/a.json" is read from the archive; paths outside
+    // every mount point are plain files.
+    // `mount` must not run concurrently with the other functions, which
+    // are thread-safe.
+    namespace VFS
+    {
+        // Returns false, after logging why, if the archive cannot be used.
+        bool mount(const std::string& mMountPoint, const Path& mArchivePath);
+
+        // Fills `mView` if `mPath` is a file of a mounted archive. Views
+        // stay valid until the program exits.
+        bool getView(const Path& mPath, FileView& mView);
+
+        bool exists(const Path& mPath);
+        std::string getContents(const Path& mPath);
+        ssvuj::Obj getJson(const Path& mPath);
+
+        // For archived files, the archive's modification time is used.
+        bool getFileStamp(
+            const Path& mPath, std::int64_t& mMtime, std::uint64_t& mSize);
+
+        // Every file inside `mFolder` and its subfolders.
+        std::vector<Path> getFilesRecursive(const Path& mFolder);
+    }
+}
+
+#endif
@@ -120,7 +120,7 @@ namespace hg
         if(hexagonGame.getLevelStatus().swapEnabled &&
             hexagonGame.getInputSwap() && !swapTimer.isRunning())
         {
-            hexagonGame.getAssets().playSound("swap.ogg");
+            hexagonGame.playSwapSound();
             swapTimer.restart();
             angle += ssvu::pi;
             hexagonGame.runLuaFunctionIfExists<void>("onCursorSwap");
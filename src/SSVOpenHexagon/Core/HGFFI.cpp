@@ -0,0 +1,172 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Core/HGFFI.hpp"
+
+#ifdef HG_USE_LUAJIT
+
+#include "SSVOpenHexagon/Core/HexagonGame.hpp"
+
+#ifdef _WIN32
+#define HG_FFI_EXPORT extern "C" __declspec(dllexport)
+#else
+#define HG_FFI_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+using namespace std;
+
+namespace hg
+{
+    // Gives the C entry points access to the game they act upon.
+    struct HGFFIBridge
+    {
+        static HexagonGame* game;
+
+        inline static void appendWall(const HGWallAction& mWall)
+        {
+            game->timeline.appendWall(mWall);
+        }
+        inline static const LevelStatus& getLevelStatus()
+        {
+            return game->levelStatus;
+        }
+        inline static float getLevelTime()
+        {
+            return (float)game->status.currentTime;
+        }
+        inline static float getDifficultyMult()
+        {
+            return game->difficultyMult;
+        }
+    };
+
+    HexagonGame* HGFFIBridge::game{nullptr};
+
+    namespace
+    {
+        // Must match the signatures of the `hg_*` functions below.
+        constexpr const char* ffiPrelude{R"(
+local ffi = require("ffi")
+ffi.cdef[[
+void hg_w_wall(int, float);
+void hg_w_wallAdj(int, float, float);
+void hg_w_wallAcc(int, float, float, float, float, float);
+void hg_w_wallHModSpeedData(float, int, float, float, float, float, float, bool);
+void hg_w_wallHModCurveData(float, int, float, float, float, float, float, bool);
+float hg_l_getRotationSpeed(void);
+unsigned int hg_l_getSides(void);
+float hg_l_getSpeedMult(void);
+float hg_l_getDelayMult(void);
+float hg_l_getLevelTime(void);
+float hg_u_getDifficultyMult(void);
+float hg_u_getSpeedMultDM(void);
+float hg_u_getDelayMultDM(void);
+]]
+local C = ffi.C
+w_wall = C.hg_w_wall
+w_wallAdj = C.hg_w_wallAdj
+w_wallAcc = C.hg_w_wallAcc
+w_wallHModSpeedData = C.hg_w_wallHModSpeedData
+w_wallHModCurveData = C.hg_w_wallHModCurveData
+l_getRotationSpeed = C.hg_l_getRotationSpeed
+l_getSides = C.hg_l_getSides
+l_getSpeedMult = C.hg_l_getSpeedMult
+l_getDelayMult = C.hg_l_getDelayMult
+l_getLevelTime = C.hg_l_getLevelTime
+u_getDifficultyMult = C.hg_u_getDifficultyMult
+u_getSpeedMultDM = C.hg_u_getSpeedMultDM
+u_getDelayMultDM = C.hg_u_getDelayMultDM
+)"};
+    }
+
+    void initFFI(Lua::LuaContext& mLua, HexagonGame& mGame)
+    {
+        HGFFIBridge::game = &mGame;
+
+        istringstream s{ffiPrelude};
+        try
+        {
+            mLua.executeCode(s);
+        }
+        catch(runtime_error& mError)
+        {
+            // The regular bindings stay in place, so scripts still work.
+            ssvu::lo("hg::initFFI") << "FFI bindings unavailable: "
+                                    << mError.what() << "\n";
+        }
+    }
+}
+
+using hg::HGFFIBridge;
+
+HG_FFI_EXPORT void hg_w_wall(int mSide, float mThickness)
+{
+    HGFFIBridge::appendWall(hg::mkWallAction(mSide, mThickness));
+}
+HG_FFI_EXPORT void hg_w_wallAdj(int mSide, float mThickness, float mSpeedAdj)
+{
+    HGFFIBridge::appendWall(hg::mkWallAction(mSide, mThickness, mSpeedAdj));
+}
+HG_FFI_EXPORT void hg_w_wallAcc(int mSide, float mThickness, float mSpeedAdj,
+    float mAcceleration, float mMinSpeed, float mMaxSpeed)
+{
+    auto w(hg::mkWallSpeedAction(mSide, mThickness, mSpeedAdj, mAcceleration,
+        mMinSpeed, mMaxSpeed));
+    w.scaleSpeedBounds = true;
+    HGFFIBridge::appendWall(w);
+}
+HG_FFI_EXPORT void hg_w_wallHModSpeedData(float mHMod, int mSide,
+    float mThickness, float mSAdj, float mSAcc, float mSMin, float mSMax,
+    bool mSPingPong)
+{
+    auto w(hg::mkWallSpeedAction(
+        mSide, mThickness, mSAdj, mSAcc, mSMin, mSMax, mHMod));
+    w.speedPingPong = mSPingPong;
+    HGFFIBridge::appendWall(w);
+}
+HG_FFI_EXPORT void hg_w_wallHModCurveData(float mHMod, int mSide,
+    float mThickness, float mCAdj, float mCAcc, float mCMin, float mCMax,
+    bool mCPingPong)
+{
+    auto w(hg::mkWallCurveAction(
+        mSide, mThickness, mCAdj, mCAcc, mCMin, mCMax, mHMod));
+    w.curvePingPong = mCPingPong;
+    HGFFIBridge::appendWall(w);
+}
+
+HG_FFI_EXPORT float hg_l_getRotationSpeed()
+{
+    return HGFFIBridge::getLevelStatus().rotationSpeed;
+}
+HG_FFI_EXPORT unsigned int hg_l_getSides()
+{
+    return HGFFIBridge::getLevelStatus().sides;
+}
+HG_FFI_EXPORT float hg_l_getSpeedMult()
+{
+    return HGFFIBridge::getLevelStatus().speedMult;
+}
+HG_FFI_EXPORT float hg_l_getDelayMult()
+{
+    return HGFFIBridge::getLevelStatus().delayMult;
+}
+HG_FFI_EXPORT float hg_l_getLevelTime()
+{
+    return HGFFIBridge::getLevelTime();
+}
+
+HG_FFI_EXPORT float hg_u_getDifficultyMult()
+{
+    return HGFFIBridge::getDifficultyMult();
+}
+HG_FFI_EXPORT float hg_u_getSpeedMultDM()
+{
+    return HGFFIBridge::game->getSpeedMultDM();
+}
+HG_FFI_EXPORT float hg_u_getDelayMultDM()
+{
+    return HGFFIBridge::game->getDelayMultDM();
+}
+
+#endif
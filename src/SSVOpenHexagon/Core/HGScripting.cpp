@@ -7,6 +7,7 @@
 #include "SSVOpenHexagon/Global/Assets.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 #include "SSVOpenHexagon/Core/HexagonGame.hpp"
+#include "SSVOpenHexagon/Core/HGFFI.hpp"
 #include "SSVOpenHexagon/Components/CWall.hpp"
 
 using namespace std;
@@ -35,8 +36,8 @@ namespace hg
             });
         lua.writeVariable("u_setMusic", [=](string mId)
             {
-                musicData = assets.getMusicData(mId);
-                musicData.firstPlay = true;
+                musicData = &assets.getMusicData(mId);
+                musicFirstPlay = true;
                 stopLevelMusic();
                 playLevelMusic();
             });
@@ -54,17 +55,11 @@ namespace hg
             });
         lua.writeVariable("u_kill", [=]
             {
-                timeline.append<Do>([=]
-                    {
-                        death(true);
-                    });
+                timeline.appendKill();
             });
         lua.writeVariable("u_eventKill", [=]
             {
-                eventTimeline.append<Do>([=]
-                    {
-                        death(true);
-                    });
+                eventTimeline.appendKill();
             });
         lua.writeVariable("u_getDifficultyMult", [=]
             {
@@ -82,73 +77,50 @@ namespace hg
         // Messages
         lua.writeVariable("m_messageAdd", [=](string mMsg, float mDuration)
             {
-                eventTimeline.append<Do>([=]
-                    {
-                        if(firstPlay && Config::getShowMessages())
-                            addMessage(mMsg, mDuration);
-                    });
+                eventTimeline.appendMessage(
+                    HGAction::Type::Message, mMsg, mDuration);
             });
         lua.writeVariable("m_messageAddImportant",
             [=](string mMsg, float mDuration)
             {
-                eventTimeline.append<Do>([=]
-                    {
-                        if(Config::getShowMessages())
-                            addMessage(mMsg, mDuration);
-                    });
+                eventTimeline.appendMessage(
+                    HGAction::Type::MessageImportant, mMsg, mDuration);
             });
 
         // Main timeline control
         lua.writeVariable("t_wait", [=](float mDuration)
             {
-                timeline.append<Wait>(mDuration);
+                timeline.appendWait(mDuration);
             });
         lua.writeVariable("t_waitS", [=](float mDuration)
             {
-                timeline.append<Wait>(ssvu::getSecondsToFT(mDuration));
+                timeline.appendWait(ssvu::getSecondsToFT(mDuration));
             });
         lua.writeVariable("t_waitUntilS", [=](float mDuration)
             {
-                timeline.append<Wait>(10);
-                timeline.append<Do>([=]
-                    {
-                        if(status.currentTime < mDuration)
-                            timeline.jumpTo(timeline.getCurrentIndex() - 2);
-                    });
+                timeline.appendWaitUntil(mDuration);
             });
 
         // Event timeline control
         lua.writeVariable("e_eventStopTime", [=](float mDuration)
             {
-                eventTimeline.append<Do>([=]
-                    {
-                        status.timeStop = mDuration;
-                    });
+                eventTimeline.appendStopTime(mDuration);
             });
         lua.writeVariable("e_eventStopTimeS", [=](float mDuration)
             {
-                eventTimeline.append<Do>([=]
-                    {
-                        status.timeStop = ssvu::getSecondsToFT(mDuration);
-                    });
+                eventTimeline.appendStopTime(ssvu::getSecondsToFT(mDuration));
             });
         lua.writeVariable("e_eventWait", [=](float mDuration)
             {
-                eventTimeline.append<Wait>(mDuration);
+                eventTimeline.appendWait(mDuration);
             });
         lua.writeVariable("e_eventWaitS", [=](float mDuration)
             {
-                eventTimeline.append<Wait>(ssvu::getSecondsToFT(mDuration));
+                eventTimeline.appendWait(ssvu::getSecondsToFT(mDuration));
             });
         lua.writeVariable("e_eventWaitUntilS", [=](float mDuration)
             {
-                eventTimeline.append<Wait>(10);
-                eventTimeline.append<Do>([=]
-                    {
-                        if(status.currentTime < mDuration)
-                            eventTimeline.jumpTo(
-                                eventTimeline.getCurrentIndex() - 2);
-                    });
+                eventTimeline.appendWaitUntil(mDuration);
             });
 
         // Level control
@@ -347,57 +319,44 @@ namespace hg
         // Wall creation
         lua.writeVariable("w_wall", [=](int mSide, float mThickness)
             {
-                timeline.append<Do>([=]
-                    {
-                        factory.createWall(
-                            mSide, mThickness, {getSpeedMultDM()});
-                    });
+                timeline.appendWall(mkWallAction(mSide, mThickness));
             });
         lua.writeVariable("w_wallAdj",
             [=](int mSide, float mThickness, float mSpeedAdj)
             {
-                timeline.append<Do>([=]
-                    {
-                        factory.createWall(
-                            mSide, mThickness, mSpeedAdj * getSpeedMultDM());
-                    });
+                timeline.appendWall(
+                    mkWallAction(mSide, mThickness, mSpeedAdj));
             });
         lua.writeVariable("w_wallAcc", [=](int mSide, float mThickness,
                                            float mSpeedAdj, float mAcceleration,
                                            float mMinSpeed, float mMaxSpeed)
             {
-                timeline.append<Do>([=]
-                    {
-                        factory.createWall(mSide, mThickness,
-                            {mSpeedAdj * getSpeedMultDM(), mAcceleration,
-                                mMinSpeed * getSpeedMultDM(),
-                                mMaxSpeed * getSpeedMultDM()});
-                    });
+                auto w(mkWallSpeedAction(mSide, mThickness, mSpeedAdj,
+                    mAcceleration, mMinSpeed, mMaxSpeed));
+                w.scaleSpeedBounds = true;
+                timeline.appendWall(w);
             });
         lua.writeVariable(
             "w_wallHModSpeedData",
             [=](float mHMod, int mSide, float mThickness, float mSAdj,
                 float mSAcc, float mSMin, float mSMax, bool mSPingPong)
             {
-                timeline.append<Do>([=]
-                    {
-                        factory.createWall(mSide, mThickness,
-                            {mSAdj * getSpeedMultDM(), mSAcc, mSMin, mSMax,
-                                mSPingPong},
-                            mHMod);
-                    });
+                auto w(mkWallSpeedAction(
+                    mSide, mThickness, mSAdj, mSAcc, mSMin, mSMax, mHMod));
+                w.speedPingPong = mSPingPong;
+                timeline.appendWall(w);
             });
         lua.writeVariable(
             "w_wallHModCurveData",
             [=](float mHMod, int mSide, float mThickness, float mCAdj,
                 float mCAcc, float mCMin, float mCMax, bool mCPingPong)
             {
-                timeline.append<Do>([=]
-                    {
-                        factory.createWall(mSide, mThickness,
-                            {getSpeedMultDM()},
-                            {mCAdj, mCAcc, mCMin, mCMax, mCPingPong}, mHMod);
-                    });
+                auto w(mkWallCurveAction(
+                    mSide, mThickness, mCAdj, mCAcc, mCMin, mCMax, mHMod));
+                w.curvePingPong = mCPingPong;
+                timeline.appendWall(w);
             });
+
+        initFFI(lua, *this);
     }
 }
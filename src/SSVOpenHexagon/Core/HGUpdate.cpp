@@ -21,6 +21,7 @@ namespace hg
     {
         updateText();
         updateFlash(mFT);
+        updateHotReload();
         effectTimelineManager.update(mFT);
 
         if(!status.started && (!Config::getRotateToStart() || inputImplCCW ||
@@ -28,7 +29,7 @@ namespace hg
         {
             status.started = true;
             messageText.setString("");
-            assets.playSound("go.ogg");
+            assets.playSound(goSound);
             assets.musicPlayer.resume();
             if(Config::getOfficial()) fpsWatcher.enable();
         }
@@ -114,16 +115,36 @@ namespace hg
             fpsWatcher.update();
         }
     }
+    void HexagonGame::updateHotReload()
+    {
+        if(!Config::getHotReload() || fileWatcher == nullptr ||
+            !fileWatcher->isEnabled())
+            return;
+
+        for(const auto& p : fileWatcher->poll())
+        {
+            if(endsWith(p, ".lua"))
+                hotReloadScript(p);
+            else if(endsWith(p, ".json"))
+                hotReloadLevel(p);
+        }
+    }
     void HexagonGame::updateEvents(FT mFT)
     {
-        eventTimeline.update(mFT);
+        eventTimeline.update(mFT, [this](const HGAction& mAction)
+            {
+                return runTimelineAction(eventTimeline, mAction);
+            });
         if(eventTimeline.isFinished())
         {
             eventTimeline.clear();
             eventTimeline.reset();
         }
 
-        messageTimeline.update(mFT);
+        messageTimeline.update(mFT, [this](const HGAction& mAction)
+            {
+                return runTimelineAction(messageTimeline, mAction);
+            });
         if(messageTimeline.isFinished())
         {
             messageTimeline.clear();
@@ -138,7 +159,12 @@ namespace hg
             status.incrementTime += ssvu::getFTToSeconds(mFT);
         }
         else
+        {
             status.timeStop -= mFT;
+
+            // Scripts are paused as well, so there is time for larger steps.
+            luaGC.step(luaGCTimeStopStepKB);
+        }
     }
     void HexagonGame::updateIncrement()
     {
@@ -160,7 +186,10 @@ namespace hg
         if(status.timeStop > 0) return;
 
         runLuaFunction<float>("onUpdate", mFT);
-        timeline.update(mFT);
+        timeline.update(mFT, [this](const HGAction& mAction)
+            {
+                return runTimelineAction(timeline, mAction);
+            });
 
         if(timeline.isFinished() && !mustChangeSides)
         {
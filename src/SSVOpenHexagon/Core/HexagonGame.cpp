@@ -33,6 +33,10 @@ namespace hg
         game.onDraw += [this]
         {
             draw();
+
+            // Rendering is done: collect garbage here rather than in the
+            // middle of `onUpdate`/`onStep`.
+            luaGC.step(luaGCStepKB);
         };
         window.onRecreation += [this]
         {
@@ -65,11 +69,14 @@ namespace hg
                 mustTakeScreenshot = true;
             },
             Input::Type::Once);
+
+        if(Config::getHotReload()) initHotReload();
     }
 
     void HexagonGame::newGame(
         const string& mId, bool mFirstPlay, float mDifficultyMult)
     {
+        reportLuaMemory();
         initFlashEffect();
 
         firstPlay = mFirstPlay;
@@ -117,9 +124,11 @@ namespace hg
         if(!mFirstPlay) runLuaFunction<void>("onUnload");
         lua = Lua::LuaContext{};
         initLua();
+        luaGC.attach(lua);
         runLuaFile(levelData->luaScriptPath);
         runLuaFunction<void>("onInit");
         runLuaFunction<void>("onLoad");
+        luaGC.collect();
         restartId = mId;
         restartFirstTime = false;
         setSides(levelStatus.sides);
@@ -140,11 +149,13 @@ namespace hg
     void HexagonGame::death(bool mForce)
     {
         fpsWatcher.disable();
-        assets.playSound("death.ogg", SoundPlayer::Mode::Abort);
+        assets.playSound(
+            deathSound, SoundPool::Mode::Abort, SoundPool::Priority::High);
 
         if(!mForce && (Config::getInvincible() || levelStatus.tutorialMode))
             return;
-        assets.playSound("gameOver.ogg", SoundPlayer::Mode::Abort);
+        assets.playSound(gameOverSound, SoundPool::Mode::Abort,
+            SoundPool::Priority::High);
 
         if(!assets.pIsLocal() && Config::isEligibleForScore())
         {
@@ -168,7 +179,7 @@ namespace hg
 
     void HexagonGame::incrementDifficulty()
     {
-        assets.playSound("levelUp.ogg");
+        assets.playSound(levelUpSound);
 
         if(levelStatus.shouldIncrement())
         {
@@ -239,44 +250,132 @@ namespace hg
     void HexagonGame::goToMenu(bool mSendScores)
     {
         assets.stopSounds();
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         fpsWatcher.disable();
 
         if(mSendScores && !status.hasDied) checkAndSaveScore();
         runLuaFunction<void>("onUnload");
+        reportLuaMemory();
         window.setGameState(mgPtr->getGame());
         mgPtr->init();
     }
+    void HexagonGame::reportLuaMemory()
+    {
+        if(restartId.empty()) return;
+
+        // Only log when a level sets a new high for this session.
+        auto& peakKB(luaPeakKBs[restartId]);
+        if(luaGC.getPeakKB() <= peakKB) return;
+
+        peakKB = luaGC.getPeakKB();
+        lo("hg::HexagonGame::reportLuaMemory")
+            << restartId << ": peak Lua memory " << peakKB << " KB\n";
+    }
     void HexagonGame::changeLevel(const string& mId, bool mFirstTime)
     {
         newGame(mId, mFirstTime, difficultyMult);
     }
+    void HexagonGame::initHotReload()
+    {
+        fileWatcher = mkUPtr<FileWatcher>();
+        for(const auto& p : assets.getPackPaths())
+        {
+            fileWatcher->watchFolder(p + "Scripts/");
+            fileWatcher->watchFolder(p + "Levels/");
+        }
+    }
+    void HexagonGame::hotReloadScript(const Path& mPath)
+    {
+        auto levelIds(assets.getLevelIdsUsingScript(mPath));
+        for(const auto& id : levelIds)
+        {
+            Online::refreshValidator(assets, id);
+            assets.refreshLevelPreview(id);
+        }
+
+        if(levelData == nullptr || !contains(levelIds, levelData->id)) return;
+
+        lo("hg::HexagonGame::hotReloadScript") << "Reloading "
+                                               << mPath.getStr() << "\n";
+        runLuaFile(mPath.getStr());
+    }
+    void HexagonGame::hotReloadLevel(const Path& mPath)
+    {
+        const auto& reloaded(assets.reloadLevelData(mPath));
+        if(reloaded == nullptr) return;
+
+        Online::refreshValidator(assets, reloaded->id);
+        assets.refreshLevelPreview(reloaded->id);
+        lo("hg::HexagonGame::hotReloadLevel")
+            << "Reloaded " << reloaded->id
+            << (reloaded == levelData ? ", applied on next restart\n"
+                                      : "\n");
+    }
     void HexagonGame::addMessage(const string& mMessage, float mDuration)
     {
-        messageTimeline.append<Do>([&, mMessage]
-            {
-                assets.playSound("beep.ogg");
-                messageText.setString(mMessage);
-            });
-        messageTimeline.append<Wait>(mDuration);
-        messageTimeline.append<Do>([=]
-            {
-                messageText.setString("");
-            });
+        messageTimeline.appendMessage(HGAction::Type::ShowMessage, mMessage);
+        messageTimeline.appendWait(mDuration);
+        messageTimeline.appendClearMessage();
+    }
+    bool HexagonGame::runTimelineAction(
+        const HGTimeline& mTimeline, const HGAction& mAction)
+    {
+        using t = HGAction::Type;
+
+        switch(mAction.type)
+        {
+            case t::WaitUntil: return status.currentTime >= mAction.value;
+            case t::Wall: spawnWall(mAction.wall); break;
+            case t::Message:
+                if(firstPlay && Config::getShowMessages())
+                    addMessage(mTimeline.getString(mAction.message.idx),
+                        mAction.message.duration);
+                break;
+            case t::MessageImportant:
+                if(Config::getShowMessages())
+                    addMessage(mTimeline.getString(mAction.message.idx),
+                        mAction.message.duration);
+                break;
+            case t::ShowMessage:
+                assets.playSound(beepSound);
+                messageText.setString(
+                    mTimeline.getString(mAction.message.idx));
+                break;
+            case t::ClearMessage: messageText.setString(""); break;
+            case t::StopTime: status.timeStop = mAction.value; break;
+            case t::Kill: death(true); break;
+            default: break;
+        }
+
+        return true;
+    }
+    void HexagonGame::spawnWall(const HGWallAction& mWall)
+    {
+        float speedMult{getSpeedMultDM()},
+            boundsMult{mWall.scaleSpeedBounds ? speedMult : 1.f};
+
+        factory.createWall(mWall.side, mWall.thickness,
+            {mWall.speedAdj * speedMult, mWall.speedAcc,
+                mWall.speedMin * boundsMult, mWall.speedMax * boundsMult,
+                mWall.speedPingPong},
+            {mWall.curveAdj, mWall.curveAcc, mWall.curveMin, mWall.curveMax,
+                mWall.curvePingPong},
+            mWall.hueMod);
     }
     void HexagonGame::setLevelData(
         const LevelData& mLevelData, bool mMusicFirstPlay)
     {
         levelData = &mLevelData;
         levelStatus = LevelStatus{};
-        styleData = assets.getStyleData(levelData->styleId);
-        musicData = assets.getMusicData(levelData->musicId);
-        musicData.firstPlay = mMusicFirstPlay;
+        styleData = assets.getStyleData(levelData->styleHandle);
+        musicData = &assets.getMusicData(levelData->musicHandle);
+        musicFirstPlay = mMusicFirstPlay;
     }
 
     void HexagonGame::playLevelMusic()
     {
-        if(!Config::getNoMusic()) musicData.playRandomSegment(assets);
+        if(!Config::getNoMusic())
+            musicData->playRandomSegment(assets, musicFirstPlay);
     }
     void HexagonGame::stopLevelMusic()
     {
@@ -304,7 +403,7 @@ namespace hg
     }
     void HexagonGame::setSides(unsigned int mSides)
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         if(mSides < 3) mSides = 3;
         levelStatus.sides = mSides;
     }
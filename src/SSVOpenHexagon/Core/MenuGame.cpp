@@ -366,7 +366,7 @@ namespace hg
 
     void MenuGame::leftAction()
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         touchDelay = 50.f;
 
         if(state == s::SLPSelect)
@@ -385,7 +385,7 @@ namespace hg
 
     void MenuGame::rightAction()
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         touchDelay = 50.f;
 
         if(state == s::SLPSelect)
@@ -403,7 +403,7 @@ namespace hg
     }
     void MenuGame::upAction()
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         touchDelay = 50.f;
 
         if(state == s::SMain)
@@ -417,7 +417,7 @@ namespace hg
     }
     void MenuGame::downAction()
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         touchDelay = 50.f;
 
         if(state == s::SMain)
@@ -431,7 +431,7 @@ namespace hg
     }
     void MenuGame::okAction()
     {
-        assets.playSound("beep.ogg");
+        assets.playSound(beepSound);
         touchDelay = 50.f;
 
         if(state == s::SLPSelect)
@@ -537,7 +537,7 @@ namespace hg
         game.addInput({{k::F1}},
             [this](FT)
             {
-                assets.playSound("beep.ogg");
+                assets.playSound(beepSound);
                 if(!assets.pIsLocal())
                 {
                     state = s::MWlcm;
@@ -553,7 +553,7 @@ namespace hg
         game.addInput({{k::F2}, {k::J}},
             [this](FT)
             {
-                assets.playSound("beep.ogg");
+                assets.playSound(beepSound);
                 if(state != s::SMain) return;
                 if(!assets.pIsLocal())
                 {
@@ -567,7 +567,7 @@ namespace hg
         game.addInput({{k::F3}, {k::K}},
             [this](FT)
             {
-                assets.playSound("beep.ogg");
+                assets.playSound(beepSound);
                 if(state != s::SMain) return;
                 state = s::MOpts;
             },
@@ -575,7 +575,7 @@ namespace hg
         game.addInput({{k::F4}, {k::L}},
             [this](FT)
             {
-                assets.playSound("beep.ogg");
+                assets.playSound(beepSound);
                 if(state == s::SMain)
                 {
                     auto p(assets.getPackPaths());
@@ -588,7 +588,7 @@ namespace hg
         game.addInput(Config::getTriggerExit(),
             [this](FT)
             {
-                assets.playSound("beep.ogg");
+                assets.playSound(beepSound);
                 bool valid{
                     (assets.pIsLocal() && assets.pIsValidLocalProfile()) ||
                     !assets.pIsLocal()};
@@ -637,84 +637,6 @@ namespace hg
             t::Once);
     }
 
-    void MenuGame::initLua(Lua::LuaContext& mLua)
-    {
-        mLua.writeVariable("u_log", [this](string mLog)
-            {
-                lo("lua-menu") << mLog << "\n";
-            });
-        mLua.writeVariable("u_execScript", [this, &mLua](string mName)
-            {
-                Utils::runLuaFile(
-                    mLua, levelData->packPath + "Scripts/" + mName);
-            });
-        mLua.writeVariable("u_getDifficultyMult", [this]
-            {
-                return 1;
-            });
-        mLua.writeVariable("u_getSpeedMultDM", [this]
-            {
-                return 1;
-            });
-        mLua.writeVariable("u_getDelayMultDM", [this]
-            {
-                return 1;
-            });
-        mLua.writeVariable("l_setRotationSpeed", [this](float mValue)
-            {
-                levelStatus.rotationSpeed = mValue;
-            });
-        mLua.writeVariable("l_setSides", [this](unsigned int mValue)
-            {
-                levelStatus.sides = mValue;
-            });
-        mLua.writeVariable("l_getRotationSpeed", [this]
-            {
-                return levelStatus.rotationSpeed;
-            });
-        mLua.writeVariable("l_getSides", [this]
-            {
-                return levelStatus.sides;
-            });
-        mLua.writeVariable("s_setPulseInc", [this](float mValue)
-            {
-                styleData.pulseIncrement = mValue;
-            });
-        mLua.writeVariable("s_setHueInc", [this](float mValue)
-            {
-                styleData.hueIncrement = mValue;
-            });
-        mLua.writeVariable("s_getHueInc", [this]
-            {
-                return styleData.hueIncrement;
-            });
-
-        // Unused functions
-        for(const auto& un :
-            {"l_setSpeedMult", "l_setSpeedInc", "l_setRotationSpeedMax",
-                "l_setRotationSpeedInc", "l_setDelayInc", "l_setFastSpin",
-                "l_setSidesMin", "l_setSidesMax", "l_setIncTime",
-                "l_setPulseMin", "l_setPulseMax", "l_setPulseSpeed",
-                "l_setPulseSpeedR", "l_setPulseDelayMax", "l_setBeatPulseMax",
-                "l_setBeatPulseDelayMax", "l_setWallSkewLeft",
-                "l_setWallSkewRight", "l_setWallAngleLeft",
-                "l_setWallAngleRight", "l_setRadiusMin", "l_setSwapEnabled",
-                "l_setTutorialMode", "l_setIncEnabled",
-                "l_enableRndSideChanges", "l_getSpeedMult", "l_getDelayMult",
-                "l_addTracked", "u_playSound", "u_isKeyPressed",
-                "u_isFastSpinning", "u_forceIncrement", "u_kill", "u_eventKill",
-                "m_messageAdd", "m_messageAddImportant", "t_wait", "t_waitS",
-                "t_waitUntilS", "e_eventStopTime", "e_eventStopTimeS",
-                "e_eventWait", "e_eventWaitS", "e_eventWaitUntilS", "w_wall",
-                "w_wallAdj", "w_wallAcc", "w_wallHModSpeedData",
-                "w_wallHModCurveData", "l_setDelayMult", "l_setMaxInc",
-                "s_setStyle", "u_setMusic", "l_getRotation", "l_setRotation",
-                "s_getCameraShake", "s_setCameraShake", "l_getOfficial"})
-            mLua.writeVariable(un, []
-                {
-                });
-    }
-
     void MenuGame::setIndex(int mIdx)
     {
         currentIndex = mIdx;
@@ -725,16 +647,17 @@ namespace hg
             currentIndex = ssvu::toInt(levelDataIds.size()) - 1;
 
         levelData = &assets.getLevelData(levelDataIds[currentIndex]);
+        assets.prefetchMusic(levelData->musicId);
 
-        styleData = assets.getStyleData(levelData->styleId);
+        styleData = assets.getStyleData(levelData->styleHandle);
         diffMults = levelData->difficultyMults;
         diffMultIdx = idxOf(diffMults, 1);
 
-        Lua::LuaContext lua;
-        initLua(lua);
-        Utils::runLuaFile(lua, levelData->luaScriptPath);
-        Utils::runLuaFunction<void>(lua, "onInit");
-        Utils::runLuaFunction<void>(lua, "onLoad");
+        const auto& preview(assets.getLevelPreview(levelData->id));
+        levelStatus.rotationSpeed = preview.rotationSpeed;
+        levelStatus.sides = preview.sides;
+        styleData.hueIncrement = preview.hueIncrement;
+        styleData.pulseIncrement = preview.pulseIncrement;
     }
 
     void MenuGame::updateLeaderboard()
@@ -964,7 +887,7 @@ namespace hg
                 if(enteredStr.size() < limit &&
                     (ssvu::isAlphanumeric(c) || ssvu::isPunctuation(c)))
                 {
-                    assets.playSound("beep.ogg");
+                    assets.playSound(beepSound);
                     enteredStr.append(toStr(c));
                 }
         }
@@ -1047,7 +970,7 @@ namespace hg
 
     void MenuGame::drawLevelSelection()
     {
-        MusicData musicData{assets.getMusicData(levelData->musicId)};
+        const auto& musicData(assets.getMusicData(levelData->musicHandle));
         const auto& packPathStr(levelData->packPath.getStr());
         PackData packData{
             assets.getPackData(packPathStr.substr(6, packPathStr.size() - 7))};
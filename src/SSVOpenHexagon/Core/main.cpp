@@ -10,6 +10,8 @@
 #include "SSVOpenHexagon/Core/MenuGame.hpp"
 #include "SSVOpenHexagon/Global/Assets.hpp"
 #include "SSVOpenHexagon/Global/Config.hpp"
+#include "SSVOpenHexagon/Utils/PackArchive.hpp"
+#include "SSVOpenHexagon/Utils/StartupReport.hpp"
 
 using namespace std;
 using namespace ssvs;
@@ -27,6 +29,32 @@ void createProfilesFolder()
     createFolder(profilesPath);
 }
 
+// Writes "Packs/foo.ohpack" for every "Packs/foo/" folder given after
+// the `pack` argument.
+int createPackArchives(const vector<string>& mArgs)
+{
+    auto itr(find(begin(mArgs), end(mArgs), "pack"));
+    for(++itr; itr != end(mArgs); ++itr)
+    {
+        auto folder(*itr);
+        while(endsWith(folder, "/")) folder.pop_back();
+
+        try
+        {
+            PackArchive::create(folder, folder + ".ohpack");
+            lo("::createPackArchives") << "Created " << folder
+                                       << ".ohpack\n";
+        }
+        catch(const std::runtime_error& mEx)
+        {
+            lo("::createPackArchives") << mEx.what() << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
 #define LOSIZ(x) ssvu::lo(#x) << sizeof(x) << std::endl
@@ -42,11 +70,19 @@ int main(int argc, char* argv[])
     vector<string> overrideIds;
     for(int i{0}; i < argc; ++i) overrideIds.emplace_back(argv[i]);
 
+    if(contains(overrideIds, "pack"))
+    {
+        auto result(createPackArchives(overrideIds));
+        ssvu::lo().flush();
+        return result;
+    }
+
     if(contains(overrideIds, "server"))
     {
         Config::loadConfig(overrideIds);
         auto levelOnlyAssets(mkUPtr<HGAssets>(true));
         Online::initializeValidators(*levelOnlyAssets);
+        StartupReport::save("startup_report.json");
         auto ohServer(mkUPtr<Online::OHServer>());
         ohServer->start();
         return 0;
@@ -62,6 +98,7 @@ int main(int argc, char* argv[])
     if(Config::getServerLocal())
         ssvu::lo("Server") << "LOCAL MODE ON" << std::endl;
 
+    StartupReport::Scope windowScope{"window"};
     GameWindow window;
     window.setTitle("Open Hexagon " + toStr(Config::getVersion()) +
                     " - by vittorio romeo - http://vittorioromeo.info");
@@ -74,6 +111,7 @@ int main(int argc, char* argv[])
     window.setMouseCursorVisible(Config::getMouseVisible());
 
     Config::setTimerStatic(window, Config::getTimerStatic());
+    windowScope.finish();
 
     auto assets(mkUPtr<HGAssets>());
     Online::initializeValidators(*assets);
@@ -92,6 +130,7 @@ int main(int argc, char* argv[])
 
     Config::saveConfig();
     assets->pSaveCurrent();
+    StartupReport::save("startup_report.json");
     saveLogToFile("log.txt");
     Online::cleanup();
 
@@ -0,0 +1,138 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <sstream>
+#include "SSVOpenHexagon/Data/LevelPreview.hpp"
+#include "SSVOpenHexagon/Utils/VFS.hpp"
+
+using namespace std;
+
+namespace hg
+{
+    namespace
+    {
+        void runPreviewFile(Lua::LuaContext& mLua, const string& mFileName,
+            LevelPreview& mPreview)
+        {
+            try
+            {
+                istringstream s{VFS::getContents(mFileName)};
+                mLua.executeCode(s);
+            }
+            catch(const std::runtime_error& mError)
+            {
+                mPreview.error +=
+                    mFileName + ": " + ssvu::toStr(mError.what()) + "\n";
+            }
+        }
+        void runPreviewFunction(
+            Lua::LuaContext& mLua, const string& mName, LevelPreview& mPreview)
+        {
+            try
+            {
+                mLua.callLuaFunction<void>(mName, ssvu::mkTpl());
+            }
+            catch(const std::runtime_error& mError)
+            {
+                mPreview.error +=
+                    mName + ": " + ssvu::toStr(mError.what()) + "\n";
+            }
+        }
+
+        void initPreviewLua(Lua::LuaContext& mLua, const LevelData& mLevelData,
+            LevelPreview& mPreview)
+        {
+            mLua.writeVariable("u_execScript",
+                [&mLua, &mLevelData, &mPreview](string mName)
+                {
+                    runPreviewFile(mLua,
+                        mLevelData.packPath + "Scripts/" + mName, mPreview);
+                });
+            mLua.writeVariable("u_getDifficultyMult", []
+                {
+                    return 1;
+                });
+            mLua.writeVariable("u_getSpeedMultDM", []
+                {
+                    return 1;
+                });
+            mLua.writeVariable("u_getDelayMultDM", []
+                {
+                    return 1;
+                });
+            mLua.writeVariable("l_setRotationSpeed", [&mPreview](float mValue)
+                {
+                    mPreview.rotationSpeed = mValue;
+                });
+            mLua.writeVariable("l_setSides", [&mPreview](unsigned int mValue)
+                {
+                    mPreview.sides = mValue;
+                });
+            mLua.writeVariable("l_getRotationSpeed", [&mPreview]
+                {
+                    return mPreview.rotationSpeed;
+                });
+            mLua.writeVariable("l_getSides", [&mPreview]
+                {
+                    return mPreview.sides;
+                });
+            mLua.writeVariable("s_setPulseInc", [&mPreview](float mValue)
+                {
+                    mPreview.pulseIncrement = mValue;
+                });
+            mLua.writeVariable("s_setHueInc", [&mPreview](float mValue)
+                {
+                    mPreview.hueIncrement = mValue;
+                });
+            mLua.writeVariable("s_getHueInc", [&mPreview]
+                {
+                    return mPreview.hueIncrement;
+                });
+
+            // Unused functions
+            for(const auto& un :
+                {"u_log", "l_setSpeedMult", "l_setSpeedInc",
+                    "l_setRotationSpeedMax", "l_setRotationSpeedInc",
+                    "l_setDelayInc", "l_setFastSpin", "l_setSidesMin",
+                    "l_setSidesMax", "l_setIncTime", "l_setPulseMin",
+                    "l_setPulseMax", "l_setPulseSpeed", "l_setPulseSpeedR",
+                    "l_setPulseDelayMax", "l_setBeatPulseMax",
+                    "l_setBeatPulseDelayMax", "l_setWallSkewLeft",
+                    "l_setWallSkewRight", "l_setWallAngleLeft",
+                    "l_setWallAngleRight", "l_setRadiusMin",
+                    "l_setSwapEnabled", "l_setTutorialMode", "l_setIncEnabled",
+                    "l_enableRndSideChanges", "l_getSpeedMult",
+                    "l_getDelayMult", "l_addTracked", "u_playSound",
+                    "u_isKeyPressed", "u_isFastSpinning", "u_forceIncrement",
+                    "u_kill", "u_eventKill", "m_messageAdd",
+                    "m_messageAddImportant", "t_wait", "t_waitS",
+                    "t_waitUntilS", "e_eventStopTime", "e_eventStopTimeS",
+                    "e_eventWait", "e_eventWaitS", "e_eventWaitUntilS",
+                    "w_wall", "w_wallAdj", "w_wallAcc", "w_wallHModSpeedData",
+                    "w_wallHModCurveData", "l_setDelayMult", "l_setMaxInc",
+                    "s_setStyle", "u_setMusic", "l_getRotation",
+                    "l_setRotation", "s_getCameraShake", "s_setCameraShake",
+                    "l_getOfficial"})
+                mLua.writeVariable(un, []
+                    {
+                    });
+        }
+    }
+
+    LevelPreview computeLevelPreview(
+        const LevelData& mLevelData, const StyleData& mStyleData)
+    {
+        LevelPreview result;
+        result.hueIncrement = mStyleData.hueIncrement;
+        result.pulseIncrement = mStyleData.pulseIncrement;
+
+        Lua::LuaContext lua;
+        initPreviewLua(lua, mLevelData, result);
+        runPreviewFile(lua, mLevelData.luaScriptPath, result);
+        runPreviewFunction(lua, "onInit", result);
+        runPreviewFunction(lua, "onLoad", result);
+
+        return result;
+    }
+}
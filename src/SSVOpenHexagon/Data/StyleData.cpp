@@ -99,11 +99,11 @@ namespace hg
 
     void StyleData::computeColors()
     {
-        currentMainColor = calculateColor(mainColorData);
+        currentMainColor = calculateColor(definition->mainColorData);
         current3DOverrideColor =
             _3dOverrideColor.a != 0 ? _3dOverrideColor : getMainColor();
         currentColors.clear();
-        for(const auto& cd : colorDatas)
+        for(const auto& cd : definition->colorDatas)
             currentColors.emplace_back(calculateColor(cd));
 
         if(currentColors.size() > 1)
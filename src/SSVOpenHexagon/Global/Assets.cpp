@@ -7,6 +7,9 @@
 #include "SSVOpenHexagon/Online/Definitions.hpp"
 #include "SSVOpenHexagon/Online/Online.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
+#include "SSVOpenHexagon/Utils/JsonCache.hpp"
+#include "SSVOpenHexagon/Utils/StartupReport.hpp"
+#include "SSVOpenHexagon/Utils/VFS.hpp"
 #include "SSVOpenHexagon/Data/MusicData.hpp"
 
 using namespace std;
@@ -19,12 +22,118 @@ using namespace ssvu::FileSystem;
 
 namespace hg
 {
+    namespace
+    {
+        // Asset files of a single pack, collected by one directory walk
+        // that does not read any file contents.
+        struct PackFiles
+        {
+            vector<Path> music, musicData, styles, levels, sounds;
+        };
+
+        PackFiles scanPack(const Path& mPackPath)
+        {
+            PackFiles result;
+            const auto& root(mPackPath.getStr());
+
+            for(const auto& p : VFS::getFilesRecursive(mPackPath))
+            {
+                // Only files directly inside one of the pack's top-level
+                // folders are assets.
+                const auto& str(p.getStr());
+                auto slash(str.find('/', root.size()));
+                if(slash == string::npos ||
+                    str.find('/', slash + 1) != string::npos)
+                    continue;
+
+                auto folder(str.substr(root.size(), slash - root.size()));
+                bool json{endsWith(str, ".json")}, ogg{endsWith(str, ".ogg")};
+
+                if(folder == "Music" && ogg)
+                    result.music.emplace_back(p);
+                else if(folder == "Music" && json)
+                    result.musicData.emplace_back(p);
+                else if(folder == "Styles" && json)
+                    result.styles.emplace_back(p);
+                else if(folder == "Levels" && json)
+                    result.levels.emplace_back(p);
+                else if(folder == "Sounds" && ogg)
+                    result.sounds.emplace_back(p);
+            }
+
+            return result;
+        }
+
+        // Data parsed from a single pack's JSON files.
+        struct PackContents
+        {
+            PackFiles files;
+            vector<MusicData> musicDatas;
+            vector<StyleData> styleDatas;
+            vector<UPtr<LevelData>> levelDatas;
+            string error;
+        };
+
+        // Thread-safe: only reads files and never touches `HGAssets`.
+        // Errors stop parsing and are reported through `error`.
+        PackContents parsePack(JsonCache& mCache, const string& mPackId,
+            const Path& mPackPath, bool mLevelsOnly)
+        {
+            PackContents result;
+
+            try
+            {
+                const auto& files(result.files = scanPack(mPackPath));
+
+                // Only files missing from `mCache` count as bytes read.
+                std::uint64_t bytes{0};
+                if(!mLevelsOnly)
+                {
+                    StartupReport::Scope scope{"musicData", mPackId};
+                    for(const auto& p : files.musicData)
+                        result.musicDatas.emplace_back(
+                            loadMusicFromJson(mCache.getFromFile(p, bytes)));
+                    scope.addBytes(bytes);
+                }
+
+                {
+                    bytes = 0;
+                    StartupReport::Scope scope{"styles", mPackId};
+                    for(const auto& p : files.styles)
+                        result.styleDatas.emplace_back(
+                            mCache.getFromFile(p, bytes), p);
+                    scope.addBytes(bytes);
+                }
+
+                bytes = 0;
+                StartupReport::Scope scope{"levels", mPackId};
+                for(const auto& p : files.levels)
+                    result.levelDatas.emplace_back(mkUPtr<LevelData>(
+                        mCache.getFromFile(p, bytes), mPackPath));
+                scope.addBytes(bytes);
+            }
+            catch(const std::runtime_error& mEx)
+            {
+                result.error = mEx.what();
+            }
+            catch(...)
+            {
+                result.error = "unknown.";
+            }
+
+            return result;
+        }
+    }
+
     HGAssets::HGAssets(bool mLevelsOnly) : levelsOnly{mLevelsOnly}
     {
+        StartupReport::Scope scope{"assets"};
+
         if(!levelsOnly)
             loadAssetsFromJson(
                 assetManager, "Assets/", getFromFile("Assets/assets.json"));
         loadAssets();
+        if(!levelsOnly) loadLevelPreviews();
 
         for(auto& v : levelDataIdsByPack)
             ssvu::sort(v.second, [&](const auto& mA, const auto& mB)
@@ -45,53 +154,101 @@ namespace hg
         lo("::loadAssets") << "loading local profiles\n";
         loadLocalProfiles();
 
-        for(const auto& packPath :
-            getScan<Mode::Single, Type::Folder>("Packs/"))
+        JsonCache jsonCache{"assetcache.bin"};
+
+        {
+            StartupReport::Scope scope{"packs"};
+
+            // Pack archives are mounted where their folder would be, so the
+            // rest of the loader does not tell them apart. A pack folder
+            // takes precedence over an archive with the same name.
+            auto packFolders(getScan<Mode::Single, Type::Folder>("Packs/"));
+            for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
+                    "Packs/", ".ohpack"))
+            {
+                const auto& str(p.getStr());
+                Path mountPoint{str.substr(0, str.size() - 7) + "/"};
+
+                if(mountPoint.exists<Type::Folder>())
+                    lo("::loadAssets") << "Ignoring " << str << ": "
+                                       << mountPoint << " exists\n";
+                else if(VFS::mount(mountPoint.getStr(), p))
+                    packFolders.emplace_back(mountPoint);
+            }
+
+            for(const auto& packPath : packFolders)
+            {
+                const auto& packPathStr(packPath.getStr());
+                string packName{packPathStr.substr(6, packPathStr.size() - 7)};
+
+                ssvuj::Obj packRoot{
+                    jsonCache.getFromFile(packPath + "pack.json")};
+                ssvu::getEmplaceUPtrMap<PackData>(packDatas, packName,
+                    packName, getExtr<string>(packRoot, "name"),
+                    getExtr<float>(packRoot, "priority"));
+            }
+
+            for(auto& p : packDatas)
+            {
+                packIds.emplace_back(p.second->id);
+                packPaths.emplace_back("Packs/" + p.second->id + "/");
+            }
+        }
+
+        // JSON parsing does not touch `HGAssets`, so packs are parsed in
+        // parallel. Audio loading and merging stay on this thread.
+        lo("::loadAssets") << "parsing " << packIds.size() << " packs\n";
+        vector<PackContents> contents(packPaths.size());
         {
-            const auto& packPathStr(packPath.getStr());
-            string packName{packPathStr.substr(6, packPathStr.size() - 7)},
-                packLua;
-            for(const auto& p : getScan<Mode::Recurse, Type::File, Pick::ByExt>(
-                    packPath, ".lua"))
-                packLua.append(p.getContentsAsStr());
-
-            ssvuj::Obj packRoot{getFromFile(packPath + "/pack.json")};
-            ssvu::getEmplaceUPtrMap<PackData>(packDatas, packName, packName,
-                getExtr<string>(packRoot, "name"),
-                getExtr<float>(packRoot, "priority"));
+            StartupReport::Scope scope{"parsing"};
+            parallelFor(packPaths.size(), [&](SizeT mIdx)
+                {
+                    contents[mIdx] = parsePack(
+                        jsonCache, packIds[mIdx], packPaths[mIdx], levelsOnly);
+                });
+            jsonCache.save();
         }
 
-        for(auto& p : packDatas)
+        for(auto i(0u); i < packIds.size(); ++i)
         {
-            const auto& pd(p.second);
-            string packId{pd->id}, packPath{"Packs/" + packId + "/"};
-            packIds.emplace_back(packId);
-            packPaths.emplace_back(packPath);
+            const auto& packId(packIds[i]);
+            auto& c(contents[i]);
 
             try
             {
                 if(!levelsOnly)
                 {
                     lo("::loadAssets") << "loading " << packId << " music\n";
-                    loadMusic(packPath);
+                    StartupReport::Scope scope{"music", packId};
+                    loadMusic(c.files.music);
                 }
-                if(!levelsOnly)
+
+                for(auto& m : c.musicDatas)
+                    if(musicHandles.emplace(m.id, musicDatas.size()).second)
+                        musicDatas.emplace_back(move(m));
+                for(auto& s : c.styleDatas)
                 {
-                    lo("::loadAssets") << "loading " << packId
-                                       << " music data\n";
-                    loadMusicData(packPath);
+                    const auto& id(s.getId());
+                    if(styleHandles.emplace(id, styleDatas.size()).second)
+                        styleDatas.emplace_back(move(s));
                 }
-                lo("::loadAssets") << "loading " << packId << " style data\n";
-                loadStyleData(packPath);
-                lo("::loadAssets") << "loading " << packId << " level data\n";
-                loadLevelData(packPath);
+                for(auto& l : c.levelDatas)
+                {
+                    levelDataIdsByPack[l->packPath].emplace_back(l->id);
+                    levelDatas.insert(make_pair(l->id, move(l)));
+                }
+
+                // Like a serial load, a parse error keeps what was read
+                // before it and skips the rest of the pack.
+                if(!c.error.empty()) throw runtime_error(c.error);
 
-                if(!levelsOnly &&
-                    Path(packPath + "Sounds/").exists<ssvufs::Type::Folder>())
+                if(!levelsOnly && !c.files.sounds.empty())
                 {
                     lo("::loadAssets") << "loading " << packId
                                        << " custom sounds\n";
-                    loadCustomSounds(packId, packPath);
+                    StartupReport::Scope scope{"sounds", packId};
+                    scope.addBytes(StartupReport::getBytes(c.files.sounds));
+                    loadCustomSounds(packId, c.files.sounds);
                 }
             }
             catch(const std::runtime_error& mEx)
@@ -108,60 +265,76 @@ namespace hg
 
             lo().flush();
         }
-    }
 
-    void HGAssets::loadCustomSounds(const string& mPackName, const Path& mPath)
-    {
-        for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
-                mPath + "Sounds/", ".ogg"))
-            assetManager.load<SoundBuffer>(
-                mPackName + "_" + p.getFileName(), p);
+        for(auto& p : levelDatas) resolveHandles(*p.second);
     }
-    void HGAssets::loadMusic(const Path& mPath)
+
+    void HGAssets::loadCustomSounds(
+        const string& mPackName, const vector<Path>& mFiles)
     {
-        for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
-                mPath + "Music/", ".ogg"))
+        for(const auto& p : mFiles)
         {
-            auto& music(
-                assetManager.load<Music>(p.getFileNameNoExtensions(), p));
-            music.setVolume(Config::getMusicVolume());
-            music.setLoop(true);
+            string id{mPackName + "_" + p.getFileName()};
+
+            FileView view;
+            if(VFS::getView(p, view))
+                assetManager.load<SoundBuffer>(id, view.data, view.size);
+            else
+                assetManager.load<SoundBuffer>(id, p);
         }
     }
-    void HGAssets::loadMusicData(const Path& mPath)
+    void HGAssets::loadMusic(const vector<Path>& mFiles)
     {
-        for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
-                mPath + "Music/", ".json"))
-        {
-            MusicData musicData{loadMusicFromJson(getFromFile(p))};
-            musicDataMap.insert(make_pair(musicData.id, musicData));
-        }
+        for(const auto& p : mFiles)
+            musicPaths.emplace(p.getFileNameNoExtensions(), p);
     }
-    void HGAssets::loadStyleData(const Path& mPath)
+    LevelPreview HGAssets::tryComputeLevelPreview(const LevelData& mLevelData)
     {
-        for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
-                mPath + "Styles/", ".json"))
+        try
         {
-            StyleData styleData{getFromFile(p), p};
-            styleDataMap.insert(make_pair(styleData.id, styleData));
+            return computeLevelPreview(
+                mLevelData, getStyleData(mLevelData.styleHandle));
+        }
+        catch(const std::exception& mEx)
+        {
+            LevelPreview result;
+            result.error = "preview: " + toStr(mEx.what()) + "\n";
+            return result;
         }
     }
-    void HGAssets::loadLevelData(const Path& mPath)
+    void HGAssets::loadLevelPreviews()
     {
-        for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
-                mPath + "Levels/", ".json"))
+        lo("::loadLevelPreviews") << "computing level previews\n";
+        StartupReport::Scope scope{"levelPreviews"};
+
+        vector<const LevelData*> levels;
+        for(const auto& p : levelDatas) levels.emplace_back(p.second.get());
+
+        // Every preview runs in its own Lua state and writes only to its own
+        // slot of `previews`, so no locking is required.
+        vector<LevelPreview> previews(levels.size());
+        parallelFor(levels.size(), [&](SizeT mIdx)
+            {
+                previews[mIdx] = tryComputeLevelPreview(*levels[mIdx]);
+            });
+
+        for(auto i(0u); i < levels.size(); ++i)
         {
-            auto levelData(new LevelData{getFromFile(p), mPath});
-            levelDataIdsByPack[levelData->packPath].emplace_back(levelData->id);
-            levelDatas.insert(
-                make_pair(levelData->id, UPtr<LevelData>(levelData)));
+            if(!previews[i].error.empty())
+                lo("::loadLevelPreviews") << levels[i]->id << "\n"
+                                          << previews[i].error;
+
+            levelPreviews[levels[i]->id] = move(previews[i]);
         }
     }
     void HGAssets::loadLocalProfiles()
     {
+        StartupReport::Scope scope{"profiles"};
+
         for(const auto& p : getScan<Mode::Single, Type::File, Pick::ByExt>(
                 "Profiles/", ".json"))
         {
+            scope.addBytes(StartupReport::getBytes({p}));
             // string fileName{getNameFromPath(p, "Profiles/", ".json")};
 
             ProfileData profileData{loadProfileFromJson(getFromFile(p))};
@@ -169,6 +342,85 @@ namespace hg
                 make_pair(profileData.getName(), profileData));
         }
     }
+    const LevelData* HGAssets::reloadLevelData(const Path& mPath)
+    {
+        const auto& pathStr(mPath.getStr());
+        auto levelsIdx(pathStr.rfind("Levels/"));
+        if(levelsIdx == string::npos) return nullptr;
+
+        try
+        {
+            LevelData levelData{
+                getFromFile(mPath), Path{pathStr.substr(0, levelsIdx)}};
+
+            auto itr(levelDatas.find(levelData.id));
+            if(itr == end(levelDatas))
+            {
+                lo("::reloadLevelData")
+                    << "New level " << levelData.id
+                    << " will be available after a restart\n";
+                return nullptr;
+            }
+
+            *itr->second = levelData;
+            resolveHandles(*itr->second);
+            return itr->second.get();
+        }
+        catch(const std::runtime_error& mEx)
+        {
+            lo("::reloadLevelData") << "Could not reload " << pathStr << ": "
+                                    << mEx.what() << "\n";
+        }
+
+        return nullptr;
+    }
+    vector<string> HGAssets::getLevelIdsUsingScript(const Path& mScriptPath)
+    {
+        vector<string> result;
+        const auto& scriptPathStr(mScriptPath.getStr());
+
+        for(const auto& p : levelDatas)
+        {
+            const auto& l(*p.second);
+            string scriptsFolder{l.packPath.getStr() + "Scripts/"};
+            if(!beginsWith(scriptPathStr, scriptsFolder)) continue;
+
+            if(l.luaScriptPath.getStr() == scriptPathStr)
+            {
+                result.emplace_back(l.id);
+                continue;
+            }
+
+            try
+            {
+                std::set<string> scriptNames;
+                recursiveFillIncludedLuaFileNames(scriptNames, l.packPath,
+                    VFS::getContents(l.luaScriptPath));
+
+                if(scriptNames.count(
+                       scriptPathStr.substr(scriptsFolder.size())) > 0)
+                    result.emplace_back(l.id);
+            }
+            catch(const std::runtime_error& mEx)
+            {
+                lo("::getLevelIdsUsingScript") << mEx.what() << "\n";
+            }
+        }
+
+        return result;
+    }
+
+    void HGAssets::refreshLevelPreview(const string& mId)
+    {
+        if(levelsOnly) return;
+
+        const auto& l(getLevelData(mId));
+        auto preview(tryComputeLevelPreview(l));
+        if(!preview.error.empty())
+            lo("::refreshLevelPreview") << mId << "\n" << preview.error;
+
+        levelPreviews[mId] = move(preview);
+    }
 
     void HGAssets::saveCurrentLocalProfile()
     {
@@ -184,15 +436,35 @@ namespace hg
         ssvuj::writeToFile(profileRoot, getCurrentLocalProfileFilePath());
     }
 
+    void HGAssets::resolveHandles(LevelData& mLevelData)
+    {
+        auto resolve([&](const auto& mHandles, const string& mId, SizeT& mOut)
+            {
+                auto itr(mHandles.find(mId));
+                if(itr != end(mHandles))
+                {
+                    mOut = itr->second;
+                    return;
+                }
+
+                mOut = NumLimits<SizeT>::max();
+                lo("::resolveHandles") << mLevelData.id << " uses unknown id "
+                                       << mId << "\n";
+            });
+
+        resolve(styleHandles, mLevelData.styleId, mLevelData.styleHandle);
+        if(!levelsOnly)
+            resolve(musicHandles, mLevelData.musicId, mLevelData.musicHandle);
+    }
     const MusicData& SSVU_ATTRIBUTE(pure) HGAssets::getMusicData(
-        const string& mId)
+        MusicHandle mHandle)
     {
-        return musicDataMap.find(mId)->second;
+        return musicDatas.at(mHandle);
     }
     const StyleData& SSVU_ATTRIBUTE(pure) HGAssets::getStyleData(
-        const string& mId)
+        StyleHandle mHandle)
     {
-        return styleDataMap.find(mId)->second;
+        return styleDatas.at(mHandle);
     }
 
     float HGAssets::getLocalScore(const string& mId)
@@ -246,19 +518,122 @@ namespace hg
 
     void HGAssets::refreshVolumes()
     {
-        soundPlayer.setVolume(Config::getSoundVolume());
+        soundPool.setVolume(Config::getSoundVolume());
         musicPlayer.setVolume(Config::getMusicVolume());
+
+        lock_guard<mutex> lock{musicMutex};
+        for(auto& m : openMusics) m.second->setVolume(Config::getMusicVolume());
     }
     void HGAssets::stopMusics() { musicPlayer.stop(); }
-    void HGAssets::stopSounds() { soundPlayer.stop(); }
-    void HGAssets::playSound(const string& mId, SoundPlayer::Mode mMode)
+    void HGAssets::stopSounds() { soundPool.stop(); }
+    HGAssets::SoundHandle HGAssets::getSoundHandle(const string& mId)
+    {
+        if(!assetManager.has<SoundBuffer>(mId)) return nullptr;
+        return &assetManager.get<SoundBuffer>(mId);
+    }
+    void HGAssets::playSound(SoundHandle mHandle, SoundPool::Mode mMode,
+        SoundPool::Priority mPriority)
     {
-        if(Config::getNoSound() || !assetManager.has<SoundBuffer>(mId)) return;
-        soundPlayer.play(assetManager.get<SoundBuffer>(mId), mMode);
+        if(Config::getNoSound() || mHandle == nullptr) return;
+        soundPool.play(*mHandle, mMode, mPriority);
     }
     void HGAssets::playMusic(const string& mId, Time mPlayingOffset)
     {
-        if(assetManager.has<Music>(mId))
-            musicPlayer.play(assetManager.get<Music>(mId), mPlayingOffset);
+        auto music(assetManager.has<Music>(mId) ? &assetManager.get<Music>(mId)
+                                                : getMusic(mId));
+        if(music == nullptr)
+        {
+            logMusicError(mId);
+            return;
+        }
+
+        playingMusic = music;
+        musicPlayer.play(*music, mPlayingOffset);
+        trimOpenMusics();
+    }
+    void HGAssets::prefetchMusic(const string& mId)
+    {
+        if(Config::getNoMusic() || musicPaths.count(mId) == 0) return;
+
+        trimOpenMusics();
+        collectMusicPrefetches();
+        musicPrefetches.emplace_back(async(launch::async, [this, mId]
+            {
+                return getMusic(mId) == nullptr ? mId : string{};
+            }));
+    }
+    void HGAssets::collectMusicPrefetches()
+    {
+        eraseRemoveIf(musicPrefetches, [this](auto& mF)
+            {
+                if(mF.wait_for(chrono::seconds(0)) != future_status::ready)
+                    return false;
+
+                const auto& failedId(mF.get());
+                if(!failedId.empty()) logMusicError(failedId);
+                return true;
+            });
+    }
+    void HGAssets::logMusicError(const string& mId)
+    {
+        auto pathItr(musicPaths.find(mId));
+        if(pathItr == end(musicPaths)) return;
+
+        lo("::getMusic") << "Could not open " << pathItr->second << "\n";
+    }
+    Music* HGAssets::getMusic(const string& mId)
+    {
+        auto findOpen([this, &mId]
+            {
+                return find_if(begin(openMusics), end(openMusics),
+                    [&mId](const auto& mP)
+                    {
+                        return mP.first == mId;
+                    });
+            });
+
+        {
+            lock_guard<mutex> lock{musicMutex};
+            auto itr(findOpen());
+            if(itr != end(openMusics))
+            {
+                rotate(begin(openMusics), itr, itr + 1);
+                return openMusics.front().second.get();
+            }
+        }
+
+        auto pathItr(musicPaths.find(mId));
+        if(pathItr == end(musicPaths)) return nullptr;
+
+        // Opening reads and decodes the file header, so it is done without
+        // holding the lock.
+        auto music(mkUPtr<Music>());
+        FileView view;
+        bool opened{VFS::getView(pathItr->second, view)
+                        ? music->openFromMemory(view.data, view.size)
+                        : music->openFromFile(pathItr->second)};
+        if(!opened) return nullptr;
+        music->setVolume(Config::getMusicVolume());
+        music->setLoop(true);
+
+        lock_guard<mutex> lock{musicMutex};
+
+        // Another thread may have opened the same track in the meantime.
+        auto itr(findOpen());
+        if(itr == end(openMusics))
+            openMusics.emplace(begin(openMusics), mId, move(music));
+        else
+            rotate(begin(openMusics), itr, itr + 1);
+
+        return openMusics.front().second.get();
+    }
+    void HGAssets::trimOpenMusics()
+    {
+        lock_guard<mutex> lock{musicMutex};
+
+        for(auto i(openMusics.size());
+            i-- > 0 && openMusics.size() > maxOpenMusics;)
+            if(openMusics[i].second.get() != playingMusic)
+                openMusics.erase(begin(openMusics) + i);
     }
 }
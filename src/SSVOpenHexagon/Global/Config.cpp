@@ -69,10 +69,12 @@ namespace hg
         auto& timerStatic(lvm.create<bool>("timer_static"));
         auto& serverLocal(lvm.create<bool>("server_local"));
         auto& serverVerbose(lvm.create<bool>("server_verbose"));
+        auto& serverStorage(lvm.create<string>("server_storage"));
         auto& mouseVisible(lvm.create<bool>("mouse_visible"));
         auto& musicSpeedMult(lvm.create<float>("music_speed_mult"));
         auto& drawTextOutlines(lvm.create<bool>("draw_text_outlines"));
         auto& rotateToStart(lvm.create<bool>("rotate_to_start"));
+        auto& hotReload(lvm.create<bool>("hot_reload"));
         auto& triggerRotateCCW(lvm.create<Trigger>("t_rotate_ccw"));
         auto& triggerRotateCW(lvm.create<Trigger>("t_rotate_cw"));
         auto& triggerFocus(lvm.create<Trigger>("t_focus"));
@@ -169,6 +171,11 @@ namespace hg
                 uneligibilityReason = "invincibility on";
                 return false;
             }
+            if(getHotReload())
+            {
+                uneligibilityReason = "hot reload on";
+                return false;
+            }
             if(getNoRotation())
             {
                 uneligibilityReason = "rotation off";
@@ -315,6 +322,7 @@ namespace hg
         void setMusicSpeedMult(float mValue) { musicSpeedMult = mValue; }
         void setDrawTextOutlines(bool mX) { drawTextOutlines = mX; }
         void setRotateToStart(bool mX) { rotateToStart = mX; }
+        void setHotReload(bool mX) { hotReload = mX; }
 
         bool SSVU_ATTRIBUTE(pure) getOnline() { return online; }
         bool SSVU_ATTRIBUTE(pure) getOfficial() { return official; }
@@ -437,6 +445,7 @@ namespace hg
         bool SSVU_ATTRIBUTE(pure) getTimerStatic() { return timerStatic; }
         bool SSVU_ATTRIBUTE(pure) getServerLocal() { return serverLocal; }
         bool SSVU_ATTRIBUTE(pure) getServerVerbose() { return serverVerbose; }
+        string getServerStorage() { return serverStorage; }
         bool SSVU_ATTRIBUTE(pure) getMouseVisible() { return mouseVisible; }
         float SSVU_ATTRIBUTE(pure) getMusicSpeedMult()
         {
@@ -447,6 +456,7 @@ namespace hg
             return drawTextOutlines;
         }
         bool SSVU_ATTRIBUTE(pure) getRotateToStart() { return rotateToStart; }
+        bool SSVU_ATTRIBUTE(pure) getHotReload() { return hotReload; }
 
         Trigger getTriggerRotateCCW() { return triggerRotateCCW; }
         Trigger getTriggerRotateCW() { return triggerRotateCW; }
@@ -4,6 +4,107 @@ namespace hg
 {
     namespace Online
     {
-        unsigned int ClientHandler::lastUid{0};
+        std::atomic<unsigned int> ClientHandler::lastUid{0};
+        constexpr std::chrono::seconds ClientHandler::timeout;
+
+        bool ClientHandler::tryAccept(sf::TcpListener& mListener)
+        {
+            if(busy || mListener.accept(socket) != sf::Socket::Done)
+                return false;
+
+            // Accepted sockets are blocking regardless of the listener.
+            socket.setBlocking(false);
+            uid = lastUid++;
+            busy = true;
+            refreshTimeout();
+            return true;
+        }
+
+        void ClientHandler::receive(std::vector<sf::Packet>& mPackets)
+        {
+            sf::Packet packet;
+
+            while(busy)
+            {
+                auto status(socket.receive(packet));
+
+                // Incomplete packets are kept by the socket until the rest
+                // of their data arrives.
+                if(status == sf::Socket::NotReady ||
+                    status == sf::Socket::Partial)
+                    return;
+
+                if(status != sf::Socket::Done)
+                {
+                    HG_LO_VERBOSE("ClientHandler") << "Client (" << uid
+                                                   << ") disconnected\n";
+                    disconnect();
+                    return;
+                }
+
+                refreshTimeout();
+                mPackets.emplace_back(packet);
+            }
+        }
+
+        void ClientHandler::flushImpl()
+        {
+            while(busy && !outgoing.empty())
+            {
+                // On `Partial`, the packet remembers how much of it was
+                // sent and must be passed again as is.
+                auto status(socket.send(outgoing.front()));
+
+                if(status == sf::Socket::NotReady ||
+                    status == sf::Socket::Partial)
+                    return;
+
+                if(status != sf::Socket::Done)
+                {
+                    HG_LO_VERBOSE("ClientHandler")
+                        << "Couldn't send packet - disconnecting\n";
+                    disconnect();
+                    return;
+                }
+
+                outgoing.pop_front();
+            }
+        }
+        void ClientHandler::flush()
+        {
+            std::lock_guard<std::mutex> lock{sendMutex};
+            flushImpl();
+        }
+
+        bool ClientHandler::send(const sf::Packet& mPacket)
+        {
+            if(!busy)
+            {
+                HG_LO_VERBOSE("ClientHandler")
+                    << "Couldn't send packet - not busy\n";
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock{sendMutex};
+            outgoing.emplace_back(mPacket);
+            flushImpl();
+            return busy;
+        }
+
+        bool ClientHandler::disconnect() { return busy.exchange(false); }
+        void ClientHandler::close()
+        {
+            disconnect();
+
+            std::lock_guard<std::mutex> lock{sendMutex};
+            outgoing.clear();
+            socket.disconnect();
+        }
+
+        bool ClientHandler::hasPendingOutput()
+        {
+            std::lock_guard<std::mutex> lock{sendMutex};
+            return !outgoing.empty();
+        }
     }
 }
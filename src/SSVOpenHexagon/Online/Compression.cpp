@@ -9,81 +9,110 @@ using namespace std;
 
 namespace hg
 {
-    string getZLibCompress(const string& mStr, int mCompressionlevel)
+    namespace
     {
-        z_stream zs;
-        memset(&zs, 0, sizeof(zs));
-
-        if(deflateInit(&zs, mCompressionlevel) != Z_OK)
-            throw(runtime_error("deflateInit failed while compressing."));
-
-        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(mStr.data()));
-        zs.avail_in = mStr.size();
-
-        int ret;
-        char outbuffer[32768];
-        string outstring;
-
-        do
-        {
-            zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-            zs.avail_out = sizeof(outbuffer);
-
-            ret = deflate(&zs, Z_FINISH);
-
-            if(outstring.size() < zs.total_out)
-                outstring.append(outbuffer, zs.total_out - outstring.size());
-        } while(ret == Z_OK);
-
-        deflateEnd(&zs);
-
-        if(ret != Z_STREAM_END)
+        [[noreturn]] void throwZLibError(
+            const char* mWhat, int mRet, const z_stream& mZs)
         {
             ostringstream oss;
-            oss << "Exception during zlib compression: (" << ret << ") "
-                << zs.msg;
+            oss << "Exception during zlib " << mWhat << ": (" << mRet << ") "
+                << (mZs.msg != nullptr ? mZs.msg : "");
             throw(runtime_error(oss.str()));
         }
 
-        return outstring;
-    }
+        struct Deflater
+        {
+            z_stream zs;
+            int level;
+
+            Deflater(int mLevel) : level{mLevel}
+            {
+                memset(&zs, 0, sizeof(zs));
+                if(deflateInit(&zs, mLevel) != Z_OK)
+                    throw(runtime_error(
+                        "deflateInit failed while compressing."));
+            }
+            ~Deflater() { deflateEnd(&zs); }
+        };
+
+        struct Inflater
+        {
+            z_stream zs;
+
+            Inflater()
+            {
+                memset(&zs, 0, sizeof(zs));
+                if(inflateInit(&zs) != Z_OK)
+                    throw(runtime_error(
+                        "inflateInit failed while decompressing."));
+            }
+            ~Inflater() { inflateEnd(&zs); }
+        };
+
+        // Setting a stream up allocates over 256KB, so each thread keeps
+        // its own and resets it instead.
+        z_stream& getDeflater(int mLevel)
+        {
+            thread_local Deflater deflater{mLevel};
+            auto& zs(deflater.zs);
 
-    string getZLibDecompress(const string& mStr)
-    {
-        z_stream zs;
-        memset(&zs, 0, sizeof(zs));
+            deflateReset(&zs);
+            if(deflater.level != mLevel)
+            {
+                const auto ret(deflateParams(&zs, mLevel, Z_DEFAULT_STRATEGY));
+                if(ret != Z_OK) throwZLibError("compression", ret, zs);
 
-        if(inflateInit(&zs) != Z_OK)
-            throw(runtime_error("inflateInit failed while decompressing."));
+                deflater.level = mLevel;
+            }
 
-        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(mStr.data()));
-        zs.avail_in = mStr.size();
+            return zs;
+        }
+        z_stream& getInflater()
+        {
+            thread_local Inflater inflater;
 
-        int ret;
-        char outbuffer[32768];
-        string outstring;
+            inflateReset(&inflater.zs);
+            return inflater.zs;
+        }
 
-        do
+        void setInput(z_stream& mZs, const char* mData, SizeT mSize)
         {
-            zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-            zs.avail_out = sizeof(outbuffer);
+            mZs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(mData));
+            mZs.avail_in = uInt(mSize);
+        }
+    }
 
-            ret = inflate(&zs, 0);
+    SizeT getZLibCompressBound(SizeT mSize, int mCompressionlevel)
+    {
+        return deflateBound(&getDeflater(mCompressionlevel), uLong(mSize));
+    }
 
-            if(outstring.size() < zs.total_out)
-                outstring.append(outbuffer, zs.total_out - outstring.size());
-        } while(ret == Z_OK);
+    SizeT zlibCompress(
+        const char* mData, SizeT mSize, char* mOut, int mCompressionlevel)
+    {
+        auto& zs(getDeflater(mCompressionlevel));
+        setInput(zs, mData, mSize);
+        zs.next_out = reinterpret_cast<Bytef*>(mOut);
+        zs.avail_out = uInt(deflateBound(&zs, uLong(mSize)));
 
-        inflateEnd(&zs);
+        // The output holds the bound, so one call finishes the stream.
+        const auto ret(deflate(&zs, Z_FINISH));
+        if(ret != Z_STREAM_END) throwZLibError("compression", ret, zs);
 
-        if(ret != Z_STREAM_END)
-        {
-            ostringstream oss;
-            oss << "Exception during zlib decompression: (" << ret << ") "
-                << zs.msg;
-            throw(runtime_error(oss.str()));
-        }
+        return zs.total_out;
+    }
 
-        return outstring;
+    void zlibDecompress(
+        const char* mData, SizeT mSize, char* mOut, SizeT mOutSize)
+    {
+        auto& zs(getInflater());
+        setInput(zs, mData, mSize);
+        zs.next_out = reinterpret_cast<Bytef*>(mOut);
+        zs.avail_out = uInt(mOutSize);
+
+        const auto ret(inflate(&zs, Z_FINISH));
+        if(ret != Z_STREAM_END) throwZLibError("decompression", ret, zs);
+        if(zs.total_out != mOutSize)
+            throw(runtime_error("zlib decompressed to an unexpected size."));
     }
 }
@@ -0,0 +1,199 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sys/stat.h>
+#include "SSVOpenHexagon/Online/Journal.hpp"
+#include "SSVOpenHexagon/Utils/MappedFile.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        constexpr SizeT Journal::headerSize;
+
+        namespace
+        {
+            std::uint32_t getChecksum(const char* mData, SizeT mSize)
+            {
+                // FNV-1a
+                std::uint32_t result{2166136261u};
+                for(auto i(0u); i < mSize; ++i)
+                {
+                    result ^= static_cast<unsigned char>(mData[i]);
+                    result *= 16777619u;
+                }
+
+                return result;
+            }
+
+            // A crash can only leave a partly written record, possibly
+            // followed by zeros the file system allocated, at the end.
+            bool isTornTail(const char* mData, std::uint64_t mOffset,
+                std::uint64_t mRecordEnd, std::uint64_t mSize)
+            {
+                return mRecordEnd >= mSize ||
+                       all_of(mData + mOffset, mData + mSize, [](char mC)
+                           {
+                               return mC == '\0';
+                           });
+            }
+
+            // Drops everything after the first `mSize` bytes of `mPath`.
+            bool truncateFile(const string& mPath, std::uint64_t mSize)
+            {
+                MappedFile in;
+                if(!in.open(mPath) || in.getSize() <= mSize) return true;
+
+                const auto tempPath(mPath + ".tmp");
+                {
+                    ofstream out{tempPath, ios::binary | ios::trunc};
+                    out.write(in.getData(), mSize);
+                    if(!out) return false;
+                }
+                in.close();
+
+                return Utils::replaceFile(tempPath, mPath);
+            }
+        }
+
+        void Journal::open(std::uint64_t mKeepSize)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            file.close();
+            file.clear();
+
+            if(mKeepSize == 0)
+                file.open(path, ios::binary | ios::trunc);
+            else
+            {
+                if(!truncateFile(path, mKeepSize))
+                    lo("hg::Journal") << "Cannot truncate " << path << "\n";
+
+                file.open(path, ios::binary | ios::app);
+            }
+
+            size = mKeepSize;
+            if(!file) lo("hg::Journal") << "Cannot write " << path << "\n";
+        }
+        void Journal::close()
+        {
+            lock_guard<std::mutex> lock{mutex};
+            file.close();
+        }
+
+        void Journal::write(ostream& mOut, const Writer& mRecord)
+        {
+            const auto& payload(mRecord.getData());
+
+            Writer header;
+            header << std::uint32_t(payload.size())
+                   << getChecksum(payload.data(), payload.size());
+
+            mOut.write(header.getData().data(), headerSize);
+            mOut.write(payload.data(), payload.size());
+        }
+
+        std::uint64_t Journal::append(const Writer& mRecord)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            write(file, mRecord);
+            file.flush();
+
+            const auto offset(size + headerSize);
+            size = offset + mRecord.getData().size();
+
+            if(!file) lo("hg::Journal") << "Cannot write " << path << "\n";
+            return offset;
+        }
+
+        bool Journal::rotate(const string& mPath)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            file.close();
+            file.clear();
+
+            if(std::rename(path.c_str(), mPath.c_str()) != 0)
+            {
+                lo("hg::Journal") << "Cannot move " << path << " to " << mPath
+                                  << "\n";
+                file.open(path, ios::binary | ios::app);
+                return false;
+            }
+
+            file.open(path, ios::binary | ios::trunc);
+            size = 0;
+            return true;
+        }
+
+        std::uint64_t Journal::replay(const string& mPath,
+            const Func<void(Reader&, std::uint64_t)>& mFn,
+            std::uint64_t mFrom, std::uint64_t mTo)
+        {
+            MappedFile in;
+            if(!in.open(mPath))
+            {
+                // `MappedFile` does not open empty files either.
+                struct stat s;
+                if(stat(mPath.c_str(), &s) == 0 ? s.st_size == 0
+                                                : errno == ENOENT)
+                    return 0;
+
+                throw runtime_error("Cannot read " + mPath);
+            }
+
+            const auto data(in.getData());
+            const std::uint64_t dataSize{min<std::uint64_t>(in.getSize(), mTo)};
+
+            auto offset(mFrom);
+            while(offset <= dataSize && dataSize - offset >= headerSize)
+            {
+                std::uint32_t payloadSize, checksum;
+                Reader header{data + offset, headerSize};
+                header >> payloadSize >> checksum;
+
+                const auto payload(data + offset + headerSize);
+                if(dataSize - offset - headerSize < payloadSize ||
+                    getChecksum(payload, payloadSize) != checksum)
+                {
+                    if(isTornTail(data, offset,
+                           offset + headerSize + payloadSize, dataSize))
+                        break;
+
+                    throw runtime_error("Damaged record at " +
+                                        to_string(offset) + " of " + mPath);
+                }
+
+                try
+                {
+                    Reader reader{payload, payloadSize};
+                    mFn(reader, offset + headerSize);
+                }
+                catch(const runtime_error& mEx)
+                {
+                    lo("hg::Journal") << "Skipping record of " << mPath << ": "
+                                      << mEx.what() << "\n";
+                }
+
+                offset += headerSize + payloadSize;
+            }
+
+            if(offset < dataSize)
+                lo("hg::Journal") << "Dropping " << dataSize - offset
+                                  << " torn bytes at the end of " << mPath
+                                  << "\n";
+
+            return min(offset, dataSize);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Online/Leaderboard.hpp"
+
+using namespace std;
+
+namespace hg
+{
+    namespace Online
+    {
+        void Leaderboard::split(UPtr<Node> mNode, float mScore,
+            const string& mUsername, bool mInclusive, UPtr<Node>& mLeft,
+            UPtr<Node>& mRight)
+        {
+            if(mNode == nullptr)
+            {
+                mLeft = nullptr;
+                mRight = nullptr;
+                return;
+            }
+
+            bool nodeGoesLeft{!isBefore(mScore, mUsername, *mNode)};
+            if(!mInclusive && nodeGoesLeft)
+                nodeGoesLeft = mScore != mNode->score ||
+                               mUsername != mNode->username;
+
+            if(nodeGoesLeft)
+            {
+                split(move(mNode->right), mScore, mUsername, mInclusive,
+                    mNode->right, mRight);
+                updateSize(*mNode);
+                mLeft = move(mNode);
+            }
+            else
+            {
+                split(move(mNode->left), mScore, mUsername, mInclusive, mLeft,
+                    mNode->left);
+                updateSize(*mNode);
+                mRight = move(mNode);
+            }
+        }
+
+        UPtr<Leaderboard::Node> Leaderboard::merge(
+            UPtr<Node> mLeft, UPtr<Node> mRight)
+        {
+            if(mLeft == nullptr) return mRight;
+            if(mRight == nullptr) return mLeft;
+
+            if(mLeft->priority > mRight->priority)
+            {
+                mLeft->right = merge(move(mLeft->right), move(mRight));
+                updateSize(*mLeft);
+                return mLeft;
+            }
+
+            mRight->left = merge(move(mLeft), move(mRight->left));
+            updateSize(*mRight);
+            return mRight;
+        }
+
+        void Leaderboard::fillTop(const UPtr<Node>& mNode, SizeT mCount,
+            vector<pair<string, float>>& mResult)
+        {
+            if(mNode == nullptr || mResult.size() >= mCount) return;
+
+            fillTop(mNode->left, mCount, mResult);
+            if(mResult.size() >= mCount) return;
+
+            mResult.emplace_back(mNode->username, mNode->score);
+            fillTop(mNode->right, mCount, mResult);
+        }
+
+        void Leaderboard::insert(float mScore, const string& mUsername)
+        {
+            UPtr<Node> left, right;
+            split(move(root), mScore, mUsername, false, left, right);
+
+            auto node(mkUPtr<Node>(mScore, mUsername, rng()));
+            root = merge(merge(move(left), move(node)), move(right));
+        }
+        void Leaderboard::erase(float mScore, const string& mUsername)
+        {
+            UPtr<Node> left, middle, right;
+            split(move(root), mScore, mUsername, false, left, right);
+            split(move(right), mScore, mUsername, true, middle, right);
+
+            // `middle` holds the erased entry, if there was one.
+            root = merge(move(left), move(right));
+        }
+
+        SizeT Leaderboard::getRank(float mScore, const string& mUsername) const
+        {
+            SizeT before{0};
+
+            for(auto node(root.get()); node != nullptr;)
+            {
+                if(isBefore(mScore, mUsername, *node))
+                {
+                    node = node->left.get();
+                    continue;
+                }
+
+                before += getSize(node->left);
+                if(mScore == node->score && mUsername == node->username)
+                    break;
+
+                ++before;
+                node = node->right.get();
+            }
+
+            return before + 1;
+        }
+
+        vector<pair<string, float>> Leaderboard::getTop(SizeT mCount) const
+        {
+            vector<pair<string, float>> result;
+            result.reserve(min(mCount, getSize()));
+            fillTop(root, mCount, result);
+            return result;
+        }
+    }
+}
@@ -0,0 +1,393 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstdio>
+#include "SSVOpenHexagon/Online/LogStorage.hpp"
+#include "SSVOpenHexagon/Utils/MappedFile.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        constexpr std::uint64_t LogStorage::mergeSize;
+        constexpr std::uint64_t LogStorage::hintInterval;
+
+        namespace
+        {
+            constexpr auto dataFileEnd(numeric_limits<std::uint64_t>::max());
+
+            // Offset of the value in a record whose payload is at `mOffset`.
+            std::uint64_t getValueOffset(
+                std::uint64_t mOffset, const string& mKey)
+            {
+                return mOffset + 2 * sizeof(std::uint32_t) + mKey.size();
+            }
+        }
+
+        void LogStorage::track(Keys& mKeys, std::uint64_t& mLiveSize,
+            const string& mKey, std::uint64_t mOffset, std::uint32_t mSize)
+        {
+            auto itr(mKeys.find(mKey));
+            if(itr == std::end(mKeys))
+                mKeys.emplace(mKey, Location{mOffset, mSize});
+            else
+            {
+                mLiveSize -= getRecordSize(mKey, itr->second.size);
+                itr->second = Location{mOffset, mSize};
+            }
+
+            mLiveSize += getRecordSize(mKey, mSize);
+        }
+
+        std::uint64_t LogStorage::replayData(const string& mPath, Keys& mKeys,
+            std::uint64_t& mLiveSize, std::uint64_t mFrom, std::uint64_t mTo)
+        {
+            return Journal::replay(mPath,
+                [&](Journal::Reader& mR, std::uint64_t mOffset)
+                {
+                    string key, value;
+                    mR >> key >> value;
+                    track(mKeys, mLiveSize, key, getValueOffset(mOffset, key),
+                        std::uint32_t(value.size()));
+                },
+                mFrom, mTo);
+        }
+
+        // Only reads files, so it runs without the lock. Returns the end of
+        // the data read, and sets `mHintEnd` to where the hint left off.
+        std::uint64_t LogStorage::readKeys(Keys& mKeys,
+            std::uint64_t& mLiveSize, std::uint64_t& mHintEnd,
+            std::uint64_t mTo)
+        {
+            // The first record of the hint holds the size of the data file
+            // it describes, and the number of keys that follow.
+            // The hint can be rebuilt from the data, so failing to read it
+            // is not an error.
+            std::uint64_t from{0}, keyCount{0};
+            bool first{true}, hintRead{true};
+            try
+            {
+                Journal::replay(hintPath,
+                    [&](Journal::Reader& mR, std::uint64_t)
+                    {
+                        if(first)
+                        {
+                            first = false;
+                            mR >> from >> keyCount;
+                            return;
+                        }
+
+                        string key;
+                        Location l;
+                        mR >> key >> l.offset >> l.size;
+                        track(mKeys, mLiveSize, key, l.offset, l.size);
+                    });
+            }
+            catch(const runtime_error& mEx)
+            {
+                lo("hg::LogStorage") << mEx.what() << "\n";
+                hintRead = false;
+            }
+
+            if(hintRead && mKeys.size() == keyCount && from <= mTo)
+            {
+                try
+                {
+                    const auto end(
+                        replayData(dataPath, mKeys, mLiveSize, from, mTo));
+                    if(end >= from)
+                    {
+                        mHintEnd = from;
+                        return end;
+                    }
+                }
+                catch(const runtime_error& mEx)
+                {
+                    // Without a hint, this already was a full replay.
+                    if(from == 0) throw;
+                    lo("hg::LogStorage") << mEx.what() << "\n";
+                }
+            }
+
+            lo("hg::LogStorage") << "Ignoring stale " << hintPath << "\n";
+
+            mKeys.clear();
+            mLiveSize = mHintEnd = 0;
+            return replayData(dataPath, mKeys, mLiveSize, 0, mTo);
+        }
+
+        bool LogStorage::readValue(const Location& mLocation, string& mValue)
+        {
+            reader.clear();
+            reader.seekg(mLocation.offset);
+
+            mValue.resize(mLocation.size);
+            reader.read(&mValue[0], mLocation.size);
+            if(reader) return true;
+
+            lo("hg::LogStorage") << "Cannot read " << dataPath << " at "
+                                 << mLocation.offset << "\n";
+            return false;
+        }
+
+        bool LogStorage::writeHint(std::uint64_t mDataEnd)
+        {
+            Keys frozen;
+            std::uint64_t frozenLiveSize{0}, frozenHintEnd;
+            if(readKeys(frozen, frozenLiveSize, frozenHintEnd, mDataEnd) !=
+                mDataEnd)
+                return false;
+
+            const auto tempPath(hintPath + ".tmp");
+
+            {
+                ofstream o{tempPath, ios::binary | ios::trunc};
+
+                Journal::Writer header;
+                header << mDataEnd << std::uint64_t(frozen.size());
+                Journal::write(o, header);
+
+                for(const auto& k : frozen)
+                {
+                    Journal::Writer w;
+                    w << k.first << k.second.offset << k.second.size;
+                    Journal::write(o, w);
+                }
+
+                o.flush();
+                if(!o)
+                {
+                    lo("hg::LogStorage") << "Cannot write " << tempPath
+                                         << "\n";
+                    return false;
+                }
+            }
+
+            if(!Utils::replaceFile(tempPath, hintPath)) return false;
+
+            hintEnd = mDataEnd;
+            return true;
+        }
+
+        // Copies the records in use as of `mDataEnd` to a new data file.
+        // Only appending the records put since then, and swapping the
+        // files, is done with the lock held.
+        void LogStorage::merge(std::uint64_t mDataEnd)
+        {
+            Keys frozen;
+            std::uint64_t frozenLiveSize{0}, frozenHintEnd;
+            if(readKeys(frozen, frozenLiveSize, frozenHintEnd, mDataEnd) !=
+                mDataEnd)
+                return;
+
+            const auto tempPath(dataPath + ".tmp");
+
+            Keys merged;
+            std::uint64_t mergedSize{0};
+
+            {
+                MappedFile in;
+                if(!in.open(dataPath) || in.getSize() < mDataEnd) return;
+
+                ofstream o{tempPath, ios::binary | ios::trunc};
+                for(const auto& k : frozen)
+                {
+                    const auto& l(k.second);
+
+                    Journal::Writer w;
+                    w << k.first << string(in.getData() + l.offset, l.size);
+                    Journal::write(o, w);
+
+                    const auto offset(mergedSize + Journal::headerSize);
+                    merged.emplace(k.first,
+                        Location{getValueOffset(offset, k.first), l.size});
+                    mergedSize = offset + w.getData().size();
+                }
+
+                o.flush();
+                if(!o)
+                {
+                    lo("hg::LogStorage") << "Cannot write " << tempPath
+                                         << "\n";
+                    return;
+                }
+            }
+
+            std::uint64_t oldSize, newSize;
+
+            {
+                lock_guard<std::mutex> lock{mutex};
+                oldSize = data.getSize();
+
+                {
+                    string tail(oldSize - mDataEnd, '\0');
+                    reader.clear();
+                    reader.seekg(mDataEnd);
+                    reader.read(&tail[0], tail.size());
+
+                    ofstream o{tempPath, ios::binary | ios::app};
+                    o.write(tail.data(), tail.size());
+                    o.flush();
+
+                    if(!reader || !o)
+                    {
+                        lo("hg::LogStorage") << "Cannot copy the end of "
+                                             << dataPath << "\n";
+                        return;
+                    }
+                }
+
+                // The new file is read back before it replaces the old one,
+                // so that a failure leaves the storage as it was.
+                auto mergedLiveSize(mergedSize);
+                newSize = replayData(
+                    tempPath, merged, mergedLiveSize, mergedSize, dataFileEnd);
+                if(newSize != mergedSize + oldSize - mDataEnd)
+                {
+                    lo("hg::LogStorage") << "Cannot read back " << tempPath
+                                         << "\n";
+                    return;
+                }
+
+                // A hint describing the old file must not outlive it.
+                std::remove(hintPath.c_str());
+                hintEnd = 0;
+
+                data.close();
+                reader.close();
+
+                if(Utils::replaceFile(tempPath, dataPath))
+                {
+                    keys.swap(merged);
+                    liveSize = mergedLiveSize;
+                    data.open(newSize);
+                }
+                else
+                {
+                    lo("hg::LogStorage") << "Cannot replace " << dataPath
+                                         << "\n";
+                    data.open(oldSize);
+                }
+
+                reader.clear();
+                reader.open(dataPath, ios::binary);
+                newSize = data.getSize();
+            }
+
+            writeHint(newSize);
+            lo("hg::LogStorage") << "Merged " << dataPath << " from "
+                                 << oldSize << " to " << newSize
+                                 << " bytes\n";
+        }
+
+        LogStorage::LogStorage(const string& mPath)
+            : dataPath{mPath + ".db"}, hintPath{mPath + ".hint"},
+              data{dataPath}
+        {
+            // Drops the torn record a crash may have left at the end.
+            data.open(readKeys(keys, liveSize, hintEnd, dataFileEnd));
+            reader.open(dataPath, ios::binary);
+
+            lo("hg::LogStorage") << "Loaded " << keys.size() << " keys from "
+                                 << dataPath << "\n";
+        }
+        LogStorage::~LogStorage()
+        {
+            lock_guard<std::mutex> lock{compactionMutex};
+
+            const auto size(data.getSize());
+            try
+            {
+                if(size != hintEnd) writeHint(size);
+            }
+            catch(const runtime_error& mEx)
+            {
+                lo("hg::LogStorage") << "Cannot write " << hintPath << ": "
+                                     << mEx.what() << "\n";
+            }
+        }
+
+        bool LogStorage::has(const string& mKey)
+        {
+            lock_guard<std::mutex> lock{mutex};
+            return keys.count(mKey) > 0;
+        }
+
+        bool LogStorage::get(const string& mKey, string& mValue)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            auto itr(keys.find(mKey));
+            return itr != std::end(keys) && readValue(itr->second, mValue);
+        }
+        void LogStorage::put(const string& mKey, const string& mValue)
+        {
+            Journal::Writer w;
+            w << mKey << mValue;
+
+            lock_guard<std::mutex> lock{mutex};
+            const auto offset(data.append(w));
+            track(keys, liveSize, mKey, getValueOffset(offset, mKey),
+                std::uint32_t(mValue.size()));
+        }
+
+        void LogStorage::scanKeys(const string& mPrefix, const KeyFn& mFn)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            for(auto itr(keys.lower_bound(mPrefix));
+                itr != std::end(keys) &&
+                itr->first.compare(0, mPrefix.size(), mPrefix) == 0;
+                ++itr)
+                mFn(itr->first);
+        }
+        void LogStorage::scan(const string& mPrefix, const RecordFn& mFn)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            string value;
+            for(auto itr(keys.lower_bound(mPrefix));
+                itr != std::end(keys) &&
+                itr->first.compare(0, mPrefix.size(), mPrefix) == 0;
+                ++itr)
+                if(readValue(itr->second, value)) mFn(itr->first, value);
+        }
+
+        bool LogStorage::isEmpty()
+        {
+            lock_guard<std::mutex> lock{mutex};
+            return keys.empty();
+        }
+
+        void LogStorage::compact()
+        {
+            lock_guard<std::mutex> lock{compactionMutex};
+
+            std::uint64_t size, usedSize;
+            {
+                lock_guard<std::mutex> dataLock{mutex};
+                size = data.getSize();
+                usedSize = liveSize;
+            }
+
+            // Failing to read the data leaves every file as it is.
+            try
+            {
+                if(size >= mergeSize && size >= 2 * usedSize)
+                    merge(size);
+                else if(size >= hintEnd + hintInterval)
+                    writeHint(size);
+            }
+            catch(const runtime_error& mEx)
+            {
+                lo("hg::LogStorage") << "Compaction failed: " << mEx.what()
+                                     << "\n";
+            }
+        }
+    }
+}
@@ -0,0 +1,172 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstdio>
+#include "SSVOpenHexagon/Online/MemoryStorage.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        constexpr std::uint64_t MemoryStorage::compactionSize;
+
+        void MemoryStorage::replay(const string& mPath, Records& mRecords)
+        {
+            SizeT count{0};
+            Journal::replay(mPath, [&mRecords, &count](Journal::Reader& mR,
+                                       std::uint64_t)
+                {
+                    string key, value;
+                    mR >> key >> value;
+                    mRecords[key] = mv(value);
+                    ++count;
+                });
+
+            if(count > 0)
+                lo("hg::MemoryStorage") << "Replayed " << count
+                                        << " records from " << mPath << "\n";
+        }
+
+        bool MemoryStorage::saveSnapshot(const Records& mRecords)
+        {
+            const auto tempPath(snapshotPath + ".tmp");
+
+            {
+                ofstream o{tempPath, ios::binary | ios::trunc};
+                for(const auto& r : mRecords)
+                {
+                    Journal::Writer w;
+                    w << r.first << r.second;
+                    Journal::write(o, w);
+                }
+
+                o.flush();
+                if(!o)
+                {
+                    lo("hg::MemoryStorage") << "Cannot write " << tempPath
+                                            << "\n";
+                    return false;
+                }
+            }
+
+            return Utils::replaceFile(tempPath, snapshotPath);
+        }
+
+        MemoryStorage::MemoryStorage(const string& mPath)
+            : snapshotPath{mPath + ".snapshot"},
+              journalPath{mPath + ".journal"},
+              oldJournalPath{mPath + ".journal.old"}, journal{journalPath}
+        {
+            // A crash may leave both journals behind; the old one holds the
+            // older records. Both are folded into a new snapshot, so that
+            // the new journal starts empty, without any torn record left at
+            // its end.
+            replay(snapshotPath, records);
+            replay(oldJournalPath, records);
+            replay(journalPath, records);
+            if(!saveSnapshot(records))
+                throw runtime_error("Cannot save " + snapshotPath);
+
+            std::remove(oldJournalPath.c_str());
+            journal.open();
+        }
+
+        bool MemoryStorage::has(const string& mKey)
+        {
+            lock_guard<std::mutex> lock{mutex};
+            return records.count(mKey) > 0;
+        }
+
+        bool MemoryStorage::get(const string& mKey, string& mValue)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            auto itr(records.find(mKey));
+            if(itr == std::end(records)) return false;
+
+            mValue = itr->second;
+            return true;
+        }
+        void MemoryStorage::put(const string& mKey, const string& mValue)
+        {
+            Journal::Writer w;
+            w << mKey << mValue;
+
+            // The journal is appended to with the lock held, so that its
+            // records are in the same order as the changes.
+            lock_guard<std::mutex> lock{mutex};
+            records[mKey] = mValue;
+            journal.append(w);
+        }
+
+        void MemoryStorage::scanKeys(const string& mPrefix, const KeyFn& mFn)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            for(auto itr(records.lower_bound(mPrefix));
+                itr != std::end(records) &&
+                itr->first.compare(0, mPrefix.size(), mPrefix) == 0;
+                ++itr)
+                mFn(itr->first);
+        }
+        void MemoryStorage::scan(const string& mPrefix, const RecordFn& mFn)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            for(auto itr(records.lower_bound(mPrefix));
+                itr != std::end(records) &&
+                itr->first.compare(0, mPrefix.size(), mPrefix) == 0;
+                ++itr)
+                mFn(itr->first, itr->second);
+        }
+
+        bool MemoryStorage::isEmpty()
+        {
+            lock_guard<std::mutex> lock{mutex};
+            return records.empty();
+        }
+
+        // Only briefly stops `put`, to move the journal aside. The files
+        // read are not written to meanwhile, but the records they hold are
+        // all read back into memory while the snapshot is built.
+        void MemoryStorage::compact()
+        {
+            lock_guard<std::mutex> lock{compactionMutex};
+            if(journal.getSize() < compactionSize) return;
+
+            // The old journal is only left behind by a failed snapshot.
+            if(!Path{oldJournalPath}.exists<ssvufs::Type::File>() &&
+                !journal.rotate(oldJournalPath))
+                return;
+
+            // A snapshot missing any of these records would replace the
+            // only other copy of them.
+            Records frozen;
+            try
+            {
+                replay(snapshotPath, frozen);
+                replay(oldJournalPath, frozen);
+            }
+            catch(const runtime_error& mEx)
+            {
+                lo("hg::MemoryStorage") << mEx.what() << ", keeping "
+                                        << oldJournalPath << "\n";
+                return;
+            }
+
+            if(!saveSnapshot(frozen))
+            {
+                lo("hg::MemoryStorage") << "Snapshot failed, keeping "
+                                        << oldJournalPath << "\n";
+                return;
+            }
+
+            std::remove(oldJournalPath.c_str());
+        }
+    }
+}
@@ -8,6 +8,8 @@
 #include "SSVOpenHexagon/Global/Config.hpp"
 #include "SSVOpenHexagon/Online/Definitions.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
+#include "SSVOpenHexagon/Utils/MD5.hpp"
+#include "SSVOpenHexagon/Utils/StartupReport.hpp"
 #include "SSVOpenHexagon/Online/OHServer.hpp"
 #include "SSVOpenHexagon/Global/Assets.hpp"
 
@@ -47,89 +49,123 @@ namespace hg
 
         bool newUserReg{false}, needsCleanup{false};
 
-        string currentUsername{"NULL"}, currentLeaderboard{"NULL"},
-            currentUserStatsStr{"NULL"};
+        string currentUsername{"NULL"}, currentLeaderboard{"NULL"};
         UserStats currentUserStats;
         ssvuj::Obj currentFriendScores;
 
-        void refreshUserStats()
-        {
-            ssvuj::Obj root{getFromStr(currentUserStatsStr)};
-            currentUserStats = ssvuj::getExtr<UserStats>(root);
-        }
-
         void setCurrentGtm(GlobalThreadManager& mGtm) { currentGtm = &mGtm; }
 
         void initializeClient()
         {
             clientPHandler[FromServer::LoginResponseValid] = [](
-                Client&, Packet& mP)
+                Client&, PacketReader& mP)
             {
                 lo("PacketHandler") << "Successfully logged in!\n";
                 loginStatus = LoginStat::Logged;
-                newUserReg = ssvuj::getExtr<bool>(getDecompressedPacket(mP), 0);
+                extrPacket<FromServer::LoginResponseValid>(mP, newUserReg);
                 trySendInitialRequests();
             };
             clientPHandler[FromServer::LoginResponseInvalid] = [](
-                Client&, Packet&)
+                Client&, PacketReader&)
             {
                 loginStatus = LoginStat::Unlogged;
                 lo("PacketHandler") << "Login invalid!\n";
             };
             clientPHandler[FromServer::RequestInfoResponse] = [](
-                Client&, Packet& mP)
+                Client&, PacketReader& mP)
             {
-                ssvuj::Obj r{getDecompressedPacket(mP)};
-                serverVersion = ssvuj::getExtr<float>(r, 0);
-                serverMessage = ssvuj::getExtr<string>(r, 1);
+                extrPacket<FromServer::RequestInfoResponse>(
+                    mP, serverVersion, serverMessage);
             };
             clientPHandler[FromServer::SendLeaderboard] = [](
-                Client&, Packet& mP)
+                Client&, PacketReader& mP)
             {
-                currentLeaderboard =
-                    ssvuj::getExtr<string>(getDecompressedPacket(mP), 0);
+                Payload top;
+                float playerScore;
+                std::int32_t playerPosition;
+                extrPacket<FromServer::SendLeaderboard>(
+                    mP, top, playerScore, playerPosition);
+
+                string levelId;
+                LeaderboardEntries entries;
+                PacketReader topReader{top.data.data(), top.data.size()};
+                topReader.openPayload();
+                topReader >> levelId >> entries;
+
+                // Rebuilt as the JSON object the menu reads.
+                ssvuj::Obj root;
+                auto& r(ssvuj::getObj(root, "r"));
+                auto i(0u);
+                for(const auto& e : entries)
+                {
+                    auto& entry(ssvuj::getObj(r, i++));
+                    ssvuj::arch(entry, 0, e.first);
+                    ssvuj::arch(entry, 1, e.second);
+                }
+                ssvuj::arch(root, "id", levelId);
+                ssvuj::arch(root, "ps", playerScore);
+                ssvuj::arch(root, "pp", int(playerPosition));
+
+                currentLeaderboard = ssvuj::getWriteToString(root);
                 gettingLeaderboard = false;
             };
             clientPHandler[FromServer::SendLeaderboardFailed] = [](
-                Client&, Packet&)
+                Client&, PacketReader&)
             {
                 currentLeaderboard = "NULL";
                 lo("PacketHandler") << "Server failed sending leaderboard\n";
                 gettingLeaderboard = false;
             };
             clientPHandler[FromServer::SendScoreResponseValid] = [](
-                Client&, Packet&)
+                Client&, PacketReader&)
             {
                 lo("PacketHandler") << "Server successfully accepted score\n";
             };
             clientPHandler[FromServer::SendScoreResponseInvalid] = [](
-                Client&, Packet&)
+                Client&, PacketReader&)
             {
                 lo("PacketHandler") << "Server refused score\n";
             };
-            clientPHandler[FromServer::SendUserStats] = [](Client&, Packet& mP)
+            clientPHandler[FromServer::SendUserStats] = [](
+                Client&, PacketReader& mP)
             {
-                currentUserStatsStr =
-                    ssvuj::getExtr<string>(getDecompressedPacket(mP), 0);
-                refreshUserStats();
+                UserStats stats;
+                std::uint32_t minutes, deaths, restarts;
+                extrPacket<FromServer::SendUserStats>(
+                    mP, minutes, deaths, restarts, stats.trackedNames);
+
+                stats.minutesSpentPlaying = minutes;
+                stats.deaths = deaths;
+                stats.restarts = restarts;
+                currentUserStats = mv(stats);
             };
             clientPHandler[FromServer::SendUserStatsFailed] = [](
-                Client&, Packet&)
+                Client&, PacketReader&)
             {
-                currentUserStatsStr = "NULL";
                 lo("PacketHandler") << "Server failed sending user stats\n";
             };
             clientPHandler[FromServer::SendFriendsScores] = [](
-                Client&, Packet& mP)
+                Client&, PacketReader& mP)
             {
-                currentFriendScores = ssvuj::getFromStr(
-                    ssvuj::getExtr<string>(getDecompressedPacket(mP), 0));
+                FriendScores friendScores;
+                extrPacket<FromServer::SendFriendsScores>(mP, friendScores);
+
+                // Rebuilt as the JSON object the menu reads.
+                ssvuj::Obj root;
+                for(const auto& f : friendScores)
+                {
+                    ssvuj::arch(root[std::get<0>(f)], 0, std::get<1>(f));
+                    ssvuj::arch(root[std::get<0>(f)], 1, int(std::get<2>(f)));
+                }
+                currentFriendScores = mv(root);
             };
-            clientPHandler[FromServer::SendLogoutValid] = [](Client&, Packet&)
+            clientPHandler[FromServer::SendLogoutValid] = [](
+                Client&, PacketReader&)
             {
                 loginStatus = LoginStat::Unlogged;
             };
-            clientPHandler[FromServer::NUR_EmailValid] = [](Client&, Packet&)
+            clientPHandler[FromServer::NUR_EmailValid] = [](
+                Client&, PacketReader&)
             {
                 newUserReg = false;
             };
@@ -142,7 +178,7 @@ namespace hg
                     {
                         if(connectionStatus == ConnectStat::Connected)
                         {
-                            client->send(buildCPacket<FromClient::Ping>());
+                            client->send(buildPacket<FromClient::Ping>());
                             if(!client->isBusy())
                             {
                                 connectionStatus = ConnectStat::Disconnected;
@@ -187,10 +223,10 @@ namespace hg
                 });
         }
 
-        template <unsigned int TType, typename... TArgs>
+        template <FromClient TType, typename... TArgs>
         void trySendPacket(TArgs&&... mArgs)
         {
-            auto packet(buildCPacket<TType>(mArgs...));
+            auto packet(buildPacket<TType>(mArgs...));
             trySendFunc([packet]
                 {
                     client->send(packet);
@@ -251,7 +287,7 @@ namespace hg
             currentGtm->start([&mUsername, &mPassword]
                 {
                     client->send(
-                        buildCPacket<FromClient::Login>(mUsername, mPassword));
+                        buildPacket<FromClient::Login>(mUsername, mPassword));
                     currentUsername = mUsername;
 
                     std::this_thread::sleep_for(6s);
@@ -379,29 +415,232 @@ namespace hg
             return serverMessage;
         }
 
-        string getValidator(const Path& mPackPath, const string& mLevelId,
-            const string& mLevelRootString, const Path& mStyleRootPath,
-            const Path& mLuaScriptPath)
+        namespace
         {
-            string luaScriptContents{mLuaScriptPath.getContentsAsStr()};
-            std::set<string> luaScriptNames;
+            constexpr const char* validatorCachePath{"validatorcache.json"};
+
+            // `u_execScript` includes of the scripts seen while computing a
+            // batch of validators, so that scripts included by many levels
+            // are only scanned once. Thread-safe.
+            class ValidatorSources
+            {
+            private:
+                std::mutex mutex;
+                unordered_map<string, UPtr<std::set<string>>> includes;
+
+            public:
+                const std::set<string>& getIncludes(const Path& mPath)
+                {
+                    {
+                        lock_guard<std::mutex> lock{mutex};
+                        auto itr(includes.find(mPath.getStr()));
+                        if(itr != end(includes)) return *itr->second;
+                    }
+
+                    auto result(mkUPtr<std::set<string>>(
+                        getIncludedLuaFileNames(VFS::getContents(mPath))));
+
+                    lock_guard<std::mutex> lock{mutex};
+                    return *includes.emplace(mPath.getStr(), move(result))
+                                .first->second;
+                }
+            };
+
+            // Hashes validator sources as they are added, with control
+            // characters stripped, reading files in fixed-size chunks. The
+            // result matches `getMD5Hash(HG_ENCRYPT(stripped sources))`.
+            class ValidatorHasher
+            {
+            private:
+#ifdef HG_ENCRYPT_PREFIX
+                MD5 md5;
+#else
+                std::string buffered;
+#endif
+
+                inline void sink(const char* mData, SizeT mSize)
+                {
+#ifdef HG_ENCRYPT_PREFIX
+                    md5.update(mData, mSize);
+#else
+                    buffered.append(mData, mSize);
+#endif
+                }
+
+            public:
+                ValidatorHasher()
+                {
+#ifdef HG_ENCRYPT_PREFIX
+                    md5.update(HG_ENCRYPT_PREFIX);
+#endif
+                }
+
+                void add(const char* mData, SizeT mSize)
+                {
+                    char stripped[4096];
+                    SizeT count{0};
+
+                    for(auto i(0u); i < mSize; ++i)
+                    {
+                        if(isControl(mData[i])) continue;
+
+                        stripped[count++] = mData[i];
+                        if(count == sizeof(stripped))
+                        {
+                            sink(stripped, count);
+                            count = 0;
+                        }
+                    }
+
+                    sink(stripped, count);
+                }
+                inline void add(const string& mStr)
+                {
+                    add(mStr.data(), mStr.size());
+                }
+                void addFile(const Path& mPath)
+                {
+                    // Archived files are already contiguous in memory.
+                    FileView view;
+                    if(VFS::getView(mPath, view))
+                    {
+                        add(view.data, view.size);
+                        return;
+                    }
+
+                    ifstream file{mPath.getStr(), ios::binary};
+                    char chunk[16384];
+
+                    while(file.read(chunk, sizeof(chunk)), file.gcount() > 0)
+                        add(chunk, file.gcount());
 
-            recursiveFillIncludedLuaFileNames(
-                luaScriptNames, mPackPath, luaScriptContents);
+                    // Reading stops short of the end if the file is missing
+                    // or unreadable.
+                    if(!file.eof())
+                        lo("hg::Online::computeValidator")
+                            << "Cannot read " << mPath.getStr()
+                            << ", its validator will not match\n";
+                }
 
-            string toEncrypt;
-            toEncrypt += mLevelId;
-            toEncrypt += getControlStripped(mLevelRootString);
-            toEncrypt += mStyleRootPath.getContentsAsStr();
-            toEncrypt += luaScriptContents;
-            for(const auto& lsn : luaScriptNames)
+                string getDigest()
+                {
+#ifdef HG_ENCRYPT_PREFIX
+                    md5.update(HG_ENCRYPT_SUFFIX);
+                    return md5.getHexDigest();
+#else
+                    return getMD5Hash(HG_ENCRYPT(buffered));
+#endif
+                }
+            };
+
+            // Also fills `mInputs` with every file the validator depends on.
+            string computeValidator(ValidatorSources& mSources,
+                const Path& mPackPath, const string& mLevelId,
+                const string& mLevelRootString, const Path& mStyleRootPath,
+                const Path& mLuaScriptPath, vector<Path>& mInputs)
             {
-                Path path{mPackPath + "/Scripts/" + lsn};
-                toEncrypt += path.getContentsAsStr();
+                std::set<string> luaScriptNames;
+                recursiveFillIncludedLuaFileNames(luaScriptNames, mPackPath,
+                    mSources.getIncludes(mLuaScriptPath),
+                    [&mSources](const Path& mPath) -> const std::set<string>&
+                    {
+                        return mSources.getIncludes(mPath);
+                    });
+
+                ValidatorHasher hasher;
+                hasher.add(mLevelId);
+                hasher.add(mLevelRootString);
+                hasher.addFile(mStyleRootPath);
+                hasher.addFile(mLuaScriptPath);
+                mInputs.emplace_back(mStyleRootPath);
+                mInputs.emplace_back(mLuaScriptPath);
+                for(const auto& lsn : luaScriptNames)
+                {
+                    Path path{mPackPath + "/Scripts/" + lsn};
+                    hasher.addFile(path);
+                    mInputs.emplace_back(path);
+                }
+
+                return getUrlEncoded(mLevelId) + hasher.getDigest();
+            }
+
+            // Changes whenever the build's validator keys change.
+            string getValidatorKeysFingerprint()
+            {
+                return getMD5Hash(HG_ENCRYPT(string{}));
+            }
+            string getFileStampStr(const Path& mPath)
+            {
+                std::int64_t mtime;
+                std::uint64_t size;
+                if(!VFS::getFileStamp(mPath, mtime, size)) return "";
+                return toStr(mtime) + ":" + toStr(size);
+            }
+
+            // On-disk cache entries store the validator together with a
+            // hash of the level's JSON and the stamps of its input files.
+            Obj mkValidatorCacheEntry(const string& mValidator,
+                const string& mRootHash, const vector<Path>& mInputs)
+            {
+                Obj result;
+                arch(result, "validator", mValidator);
+                arch(result, "root", mRootHash);
+                for(const auto& p : mInputs)
+                    arch(getObj(result, "files"), p.getStr(),
+                        getFileStampStr(p));
+                return result;
+            }
+            bool isValidatorCacheEntryValid(
+                const Obj& mEntry, const string& mRootHash)
+            {
+                if(!isObj(mEntry) ||
+                    !isObjType<string>(getObj(mEntry, "validator")) ||
+                    getExtr<string>(mEntry, "root", "") != mRootHash)
+                    return false;
+
+                for(auto itr(begin(getObj(mEntry, "files")));
+                    itr != end(getObj(mEntry, "files")); ++itr)
+                {
+                    auto stamp(getFileStampStr(Path{itr.key().asString()}));
+                    if(stamp.empty() || !isObjType<string>(*itr) ||
+                        stamp != (*itr).asString())
+                        return false;
+                }
+
+                return true;
             }
 
-            toEncrypt = getControlStripped(toEncrypt);
-            return getUrlEncoded(mLevelId) + getMD5Hash(HG_ENCRYPT(toEncrypt));
+            // The cache left by a previous run, or an empty one if it was
+            // made with other keys or cannot be parsed.
+            Obj loadValidatorCache(const string& mKeys)
+            {
+                if(!Path{validatorCachePath}.exists<ssvufs::Type::File>())
+                    return Obj{};
+
+                try
+                {
+                    const auto& contents(
+                        Path{validatorCachePath}.getContentsAsStr());
+                    Reader reader;
+                    Obj result;
+                    if(!reader.parse(contents, result, false))
+                        throw runtime_error(
+                            reader.getFormattedErrorMessages());
+
+                    if(isObj(result) &&
+                        getExtr<string>(result, "keys", "") == mKeys &&
+                        isObj(getObj(result, "levels")))
+                        return result;
+                }
+                catch(const exception& mEx)
+                {
+                    lo("hg::Online::initializeValidators")
+                        << "Discarding unreadable " << validatorCachePath
+                        << ": " << mEx.what() << "\n";
+                }
+
+                return Obj{};
+            }
         }
 
         string getMD5Hash(const string& mStr)
@@ -409,29 +648,93 @@ namespace hg
             return encrypt<Encryption::Type::MD5>(mStr);
         }
 
+        void refreshValidator(HGAssets& mAssets, const string& mLevelId)
+        {
+            HG_LO_VERBOSE("hg::Online::refreshValidator")
+                << "Adding (" << mLevelId << ") validator\n";
+
+            const auto& l(mAssets.getLevelData(mLevelId));
+            ValidatorSources sources;
+            vector<Path> inputs;
+            const auto& validator(computeValidator(sources, l.packPath, l.id,
+                l.getRootString(),
+                mAssets.getStyleData(l.styleHandle).getRootPath(),
+                l.luaScriptPath, inputs));
+            validators.addValidator(mLevelId, validator);
+
+            HG_LO_VERBOSE("hg::Online::refreshValidator")
+                << "Added (" << mLevelId << "): " << validator << "\n";
+        }
+
         void initializeValidators(HGAssets& mAssets)
         {
             HG_LO_VERBOSE("hg::Online::initializeValidators")
                 << "Initializing validators...\n";
+            StartupReport::Scope scope{"validators"};
 
+            // `HGAssets` is not thread-safe: gather what the workers need
+            // beforehand.
+            vector<const LevelData*> levels;
+            vector<Path> stylePaths;
             for(const auto& p : mAssets.getLevelDatas())
             {
-                HG_LO_VERBOSE("hg::Online::initializeValidators")
-                    << "Adding (" << p.first << ") validator\n";
-
-                const auto& l(p.second);
-                const auto& validator(
-                    getValidator(l->packPath, l->id, l->getRootString(),
-                        mAssets.getStyleData(l->styleId).getRootPath(),
-                        l->luaScriptPath));
-                validators.addValidator(p.first, validator);
-
-                HG_LO_VERBOSE("hg::Online::initializeValidators")
-                    << "Added (" << p.first << "): " << validator << "\n";
+                levels.emplace_back(p.second.get());
+                stylePaths.emplace_back(
+                    mAssets.getStyleData(p.second->styleHandle).getRootPath());
             }
 
+            const auto& keys(getValidatorKeysFingerprint());
+            const auto& cache(loadValidatorCache(keys));
+            const auto& cachedLevels(getObj(cache, "levels"));
+
+            ValidatorSources sources;
+            vector<string> results(levels.size());
+            vector<Obj> entries(levels.size());
+            atomic<SizeT> computed{0};
+
+            parallelFor(levels.size(), [&](SizeT mIdx)
+                {
+                    const auto& l(*levels[mIdx]);
+                    auto rootString(l.getRootString());
+                    auto rootHash(getMD5Hash(rootString));
+
+                    const auto& cached(getObj(cachedLevels, l.id));
+                    if(isValidatorCacheEntryValid(cached, rootHash))
+                    {
+                        results[mIdx] = getExtr<string>(cached, "validator");
+                        entries[mIdx] = cached;
+                        return;
+                    }
+
+                    vector<Path> inputs;
+                    results[mIdx] = computeValidator(sources, l.packPath,
+                        l.id, rootString, stylePaths[mIdx], l.luaScriptPath,
+                        inputs);
+                    entries[mIdx] =
+                        mkValidatorCacheEntry(results[mIdx], rootHash, inputs);
+                    ++computed;
+
+                    const auto& packPathStr(l.packPath.getStr());
+                    StartupReport::addBytes("validators",
+                        packPathStr.substr(6, packPathStr.size() - 7),
+                        StartupReport::getBytes(inputs));
+                });
+
+            Obj newCache;
+            arch(newCache, "keys", keys);
+            for(auto i(0u); i < levels.size(); ++i)
+            {
+                validators.addValidator(levels[i]->id, results[i]);
+                getObj(newCache, "levels")[levels[i]->id] = move(entries[i]);
+            }
+
+            if(computed > 0 || getObjSize(cachedLevels) != levels.size())
+                writeToFile(newCache, validatorCachePath);
+
             HG_LO_VERBOSE("hg::Online::initializeValidators")
-                << "Finished initializing validators...\n";
+                << "Finished initializing validators (" << computed
+                << " computed, " << levels.size() - computed
+                << " cached)...\n";
         }
 
         const sf::IpAddress& getCurrentIpAddress()
@@ -0,0 +1,199 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstring>
+#include "SSVOpenHexagon/Online/Compression.hpp"
+#include "SSVOpenHexagon/Online/Protocol.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        namespace
+        {
+            // How a payload's data follows its first varint.
+            constexpr unsigned int rawPayload{0}, deflatedPayload{1};
+        }
+
+        void PacketWriter::writeVarint(std::uint64_t mValue)
+        {
+            for(; mValue >= 0x80; mValue >>= 7)
+                data += char((mValue & 0x7F) | 0x80);
+
+            data += char(mValue);
+        }
+
+        PacketWriter& PacketWriter::operator<<(bool mValue)
+        {
+            data += char(mValue ? 1 : 0);
+            return *this;
+        }
+        PacketWriter& PacketWriter::operator<<(float mValue)
+        {
+            static_assert(sizeof(float) == sizeof(std::uint32_t),
+                "Floats are sent as 32 bits");
+
+            std::uint32_t bits;
+            std::memcpy(&bits, &mValue, sizeof(bits));
+            for(auto i(0u); i < sizeof(bits); ++i)
+                data += char((bits >> (8 * i)) & 0xFF);
+
+            return *this;
+        }
+        PacketWriter& PacketWriter::operator<<(const string& mValue)
+        {
+            *this << mValue.size();
+            data += mValue;
+            return *this;
+        }
+        PacketWriter& PacketWriter::operator<<(const Payload& mValue)
+        {
+            holdsPayload = true;
+            return *this << mValue.data;
+        }
+
+        // Small payloads are sent as they are: deflating them costs more
+        // time than it saves bandwidth. Large ones are deflated straight
+        // into `mOut`, unless they hold a payload deflated already.
+        void PacketWriter::writePayload(PacketWriter& mOut) const
+        {
+            const auto start(mOut.data.size());
+            if(!holdsPayload && data.size() >= compressionThreshold)
+            {
+                mOut << deflatedPayload << data.size();
+
+                const auto offset(mOut.data.size());
+                mOut.data.resize(offset + getZLibCompressBound(data.size()));
+
+                const auto size(
+                    zlibCompress(data.data(), data.size(), &mOut.data[offset]));
+                if(size < data.size())
+                {
+                    mOut.data.resize(offset + size);
+                    return;
+                }
+
+                mOut.data.resize(start);
+            }
+
+            mOut << rawPayload;
+            mOut.data += data;
+        }
+        string PacketWriter::getPayload() const
+        {
+            PacketWriter result;
+            writePayload(result);
+            return mv(result.data);
+        }
+
+        void PacketReader::require(SizeT mSize)
+        {
+            if(SizeT(end - ptr) < mSize)
+                throw runtime_error("truncated packet");
+        }
+
+        std::uint64_t PacketReader::readVarint()
+        {
+            std::uint64_t result{0};
+            for(auto shift(0u); shift < 64; shift += 7)
+            {
+                require(1);
+                const auto byte(static_cast<unsigned char>(*ptr++));
+
+                result |= std::uint64_t(byte & 0x7F) << shift;
+                if(!(byte & 0x80)) return result;
+            }
+
+            throw runtime_error("malformed varint in packet");
+        }
+
+        PacketReader& PacketReader::operator>>(bool& mValue)
+        {
+            require(1);
+            mValue = *ptr++ != 0;
+            return *this;
+        }
+        PacketReader& PacketReader::operator>>(float& mValue)
+        {
+            std::uint32_t bits{0};
+            require(sizeof(bits));
+            for(auto i(0u); i < sizeof(bits); ++i)
+                bits |= std::uint32_t(static_cast<unsigned char>(*ptr++))
+                        << (8 * i);
+
+            std::memcpy(&mValue, &bits, sizeof(bits));
+            return *this;
+        }
+        PacketReader& PacketReader::operator>>(string& mValue)
+        {
+            SizeT size;
+            *this >> size;
+
+            require(size);
+            mValue.assign(ptr, size);
+            ptr += size;
+            return *this;
+        }
+
+        PacketReader& PacketReader::operator>>(Payload& mValue)
+        {
+            return *this >> mValue.data;
+        }
+
+        void PacketReader::openPayload()
+        {
+            unsigned int encoding;
+            *this >> encoding;
+
+            if(encoding == rawPayload) return;
+            if(encoding != deflatedPayload)
+                throw runtime_error("unknown packet payload encoding");
+
+            SizeT size;
+            *this >> size;
+
+            // Deflate cannot shrink data more than 1032 times.
+            const SizeT deflatedSize(end - ptr);
+            if(size > deflatedSize * 1032)
+                throw runtime_error("corrupted packet payload");
+
+            inflated.resize(size);
+            zlibDecompress(ptr, deflatedSize, &inflated[0], size);
+
+            ptr = inflated.data();
+            end = ptr + inflated.size();
+        }
+
+        bool PacketReader::openPacket(unsigned int& mType)
+        {
+            unsigned int version;
+            *this >> version;
+            if(version != protocolVersion) return false;
+
+            *this >> mType;
+            openPayload();
+            return true;
+        }
+
+        namespace Impl
+        {
+            // `sf::Packet` can only be appended to, so the packet is built
+            // in a buffer each thread reuses, then copied in at once.
+            sf::Packet buildPacket(unsigned int mType, const PacketWriter& mW)
+            {
+                thread_local PacketWriter buffer;
+                buffer.clear();
+                buffer << protocolVersion << mType;
+                mW.writePayload(buffer);
+
+                sf::Packet result;
+                result.append(buffer.getData().data(), buffer.getData().size());
+                return result;
+            }
+        }
+    }
+}
@@ -0,0 +1,205 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Online/Server.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        void Server::dispatch(
+            const ClientPtr& mClient, sf::Packet mPacket, bool mDisconnect)
+        {
+            auto& w(*workers[mClient->getUid() % workers.size()]);
+
+            {
+                lock_guard<mutex> lock{w.mutex};
+                w.tasks.emplace_back(Task{mClient, move(mPacket), mDisconnect});
+            }
+
+            w.cv.notify_one();
+        }
+
+        void Server::removeClient(IOThread& mIO, const ClientPtr& mClient)
+        {
+            mIO.selector.remove(mClient->getSocket());
+            mClient->close();
+            dispatch(mClient, {}, true);
+        }
+
+        void Server::acceptClients(IOThread& mIO)
+        {
+            // Every I/O thread is woken up by a pending connection, but
+            // only one of them accepts it.
+            while(running)
+            {
+                auto ch(make_shared<ClientHandler>());
+                if(!ch->tryAccept(listener)) return;
+
+                mIO.selector.add(ch->getSocket());
+                onClientAccepted(*ch);
+                HG_LO_VERBOSE("Server") << "Accepted client (" << ch->getUid()
+                                        << ")\n";
+
+                mIO.clientHandlers.emplace_back(move(ch));
+            }
+        }
+
+        void Server::updateClients(IOThread& mIO)
+        {
+            auto now(chrono::steady_clock::now());
+            bool checkTimeouts{now - mIO.lastTimeoutCheck > 800ms};
+            if(checkTimeouts) mIO.lastTimeoutCheck = now;
+
+            for(const auto& ch : mIO.clientHandlers)
+            {
+                if(mIO.selector.isReady(ch->getSocket()))
+                {
+                    mIO.received.clear();
+                    ch->receive(mIO.received);
+                    for(auto& p : mIO.received) dispatch(ch, move(p));
+                }
+
+                if(ch->hasPendingOutput()) ch->flush();
+
+                if(checkTimeouts && ch->isBusy() && ch->hasTimedOut(now))
+                {
+                    HG_LO_VERBOSE("Server") << "Client (" << ch->getUid()
+                                            << ") timed out\n";
+                    ch->disconnect();
+                }
+            }
+
+            // Clients may also be disconnected by their worker.
+            eraseRemoveIf(mIO.clientHandlers, [this, &mIO](const auto& mCH)
+                {
+                    if(mCH->isBusy()) return false;
+
+                    removeClient(mIO, mCH);
+                    return true;
+                });
+        }
+
+        void Server::runIOThread(IOThread& mIO)
+        {
+            mIO.selector.add(listener);
+
+            while(running)
+            {
+                // The timeout bounds how late a stop request, a timed out
+                // client or a packet that could not be sent at once is
+                // noticed.
+                bool pendingOutput{false};
+                for(const auto& ch : mIO.clientHandlers)
+                    pendingOutput |= ch->hasPendingOutput();
+
+                auto ready(mIO.selector.wait(
+                    sf::milliseconds(pendingOutput ? 5 : 100)));
+
+                if(ready && mIO.selector.isReady(listener))
+                    acceptClients(mIO);
+
+                updateClients(mIO);
+            }
+
+            for(const auto& ch : mIO.clientHandlers) removeClient(mIO, ch);
+            mIO.clientHandlers.clear();
+            mIO.selector.clear();
+        }
+
+        void Server::runWorker(Worker& mWorker)
+        {
+            while(true)
+            {
+                Task task;
+
+                {
+                    unique_lock<mutex> lock{mWorker.mutex};
+                    mWorker.cv.wait(lock, [this, &mWorker]
+                        {
+                            return !mWorker.tasks.empty() || !workersRunning;
+                        });
+
+                    if(mWorker.tasks.empty()) return;
+
+                    task = move(mWorker.tasks.front());
+                    mWorker.tasks.pop_front();
+                }
+
+                if(task.disconnect)
+                    task.client->onDisconnect();
+                else
+                    packetHandler.handle(*task.client, task.packet);
+            }
+        }
+
+        void Server::start(
+            unsigned short mPort, SizeT mIOThreadCount, SizeT mWorkerCount)
+        {
+            if(listener.listen(mPort) != sf::Socket::Done)
+            {
+                lo("Server") << "Error initalizing listener\n";
+                return;
+            }
+            else
+                lo("Server") << "Listener initialized\n";
+
+            SizeT cores{max(1u, thread::hardware_concurrency())};
+            if(mIOThreadCount == 0) mIOThreadCount = min(SizeT(4), cores);
+            if(mWorkerCount == 0) mWorkerCount = cores;
+
+            // Workers must exist before any packet is dispatched.
+            workersRunning = true;
+            for(auto i(0u); i < mWorkerCount; ++i)
+            {
+                auto& w(getEmplaceUPtr<Worker>(workers));
+                w.future = async(launch::async, [this, &w]
+                    {
+                        runWorker(w);
+                    });
+            }
+
+            running = true;
+            for(auto i(0u); i < mIOThreadCount; ++i)
+            {
+                auto& io(getEmplaceUPtr<IOThread>(ioThreads));
+                io.future = async(launch::async, [this, &io]
+                    {
+                        runIOThread(io);
+                    });
+            }
+
+            lo("Server") << "Serving from " << mIOThreadCount
+                         << " I/O threads and " << mWorkerCount
+                         << " workers\n";
+        }
+
+        void Server::stop()
+        {
+            running = false;
+            for(auto& io : ioThreads)
+                if(io->future.valid()) io->future.get();
+            ioThreads.clear();
+
+            workersRunning = false;
+            for(auto& w : workers)
+            {
+                {
+                    // Taken so that no worker misses the notification
+                    // between checking its condition and waiting.
+                    lock_guard<mutex> lock{w->mutex};
+                }
+                w->cv.notify_all();
+            }
+            for(auto& w : workers)
+                if(w->future.valid()) w->future.get();
+            workers.clear();
+
+            listener.close();
+        }
+    }
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Online/Storage.hpp"
+#include "SSVOpenHexagon/Online/LogStorage.hpp"
+#include "SSVOpenHexagon/Online/MemoryStorage.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace Online
+    {
+        UPtr<Storage> createStorage(const string& mEngine, const string& mPath)
+        {
+            if(mEngine == "memory") return mkUPtr<MemoryStorage>(mPath);
+
+            if(mEngine != "log")
+                lo("hg::Online") << "Unknown storage engine " << mEngine
+                                 << ", using log\n";
+
+            return mkUPtr<LogStorage>(mPath);
+        }
+    }
+}
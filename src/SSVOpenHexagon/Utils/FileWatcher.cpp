@@ -0,0 +1,91 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/FileWatcher.hpp"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+using namespace std;
+using namespace ssvu;
+using namespace ssvu::FileSystem;
+
+namespace hg
+{
+#ifdef __linux__
+    FileWatcher::FileWatcher() : fd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+    {
+        if(fd == -1)
+            lo("hg::FileWatcher") << "inotify unavailable, not watching\n";
+    }
+    FileWatcher::~FileWatcher()
+    {
+        if(fd != -1) close(fd);
+    }
+
+    void FileWatcher::watchFolderImpl(const string& mPath)
+    {
+        int wd{inotify_add_watch(
+            fd, mPath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO)};
+        if(wd == -1)
+        {
+            lo("hg::FileWatcher") << "Could not watch " << mPath << "\n";
+            return;
+        }
+
+        watchedFolders[wd] = mPath;
+    }
+
+    const vector<string>& FileWatcher::poll()
+    {
+        changedFiles.clear();
+        if(fd == -1) return changedFiles;
+
+        alignas(inotify_event) char buffer[4096];
+
+        while(true)
+        {
+            auto length(read(fd, buffer, sizeof(buffer)));
+            if(length <= 0) break;
+
+            for(auto ptr(buffer); ptr < buffer + length;)
+            {
+                const auto& event(*reinterpret_cast<inotify_event*>(ptr));
+                ptr += sizeof(inotify_event) + event.len;
+
+                auto itr(watchedFolders.find(event.wd));
+                if(event.len == 0 || itr == end(watchedFolders)) continue;
+
+                string path{itr->second + event.name};
+                if(!contains(changedFiles, path))
+                    changedFiles.emplace_back(move(path));
+            }
+        }
+
+        return changedFiles;
+    }
+#else
+    FileWatcher::FileWatcher()
+    {
+        lo("hg::FileWatcher")
+            << "File watching unsupported on this platform\n";
+    }
+    FileWatcher::~FileWatcher() {}
+
+    void FileWatcher::watchFolderImpl(const string&) {}
+
+    const vector<string>& FileWatcher::poll() { return changedFiles; }
+#endif
+
+    void FileWatcher::watchFolder(const Path& mPath)
+    {
+        if(!isEnabled() || !mPath.exists<ssvufs::Type::Folder>()) return;
+
+        watchFolderImpl(mPath.getStr());
+        for(const auto& p : getScan<Mode::Recurse, Type::Folder>(mPath))
+            watchFolderImpl(p.getStr());
+    }
+}
@@ -0,0 +1,285 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstring>
+#include <fstream>
+#include "SSVOpenHexagon/Utils/JsonCache.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+#include "SSVOpenHexagon/Utils/VFS.hpp"
+
+using namespace std;
+using namespace ssvu;
+
+namespace hg
+{
+    namespace
+    {
+        constexpr char cacheMagic[4]{'O', 'H', 'J', 'C'};
+        constexpr std::uint32_t cacheVersion{1};
+
+        template <typename T>
+        void write(string& mOut, const T& mValue)
+        {
+            mOut.append(reinterpret_cast<const char*>(&mValue), sizeof(T));
+        }
+        void writeStr(string& mOut, const string& mStr)
+        {
+            write(mOut, std::uint32_t(mStr.size()));
+            mOut.append(mStr);
+        }
+
+        void encode(string& mOut, const ssvuj::Obj& mObj)
+        {
+            write(mOut, std::uint8_t(mObj.type()));
+
+            switch(mObj.type())
+            {
+                case Json::nullValue: break;
+                case Json::intValue: write(mOut, mObj.asLargestInt()); break;
+                case Json::uintValue: write(mOut, mObj.asLargestUInt()); break;
+                case Json::realValue: write(mOut, mObj.asDouble()); break;
+                case Json::stringValue: writeStr(mOut, mObj.asString()); break;
+                case Json::booleanValue:
+                    write(mOut, std::uint8_t(mObj.asBool()));
+                    break;
+                case Json::arrayValue:
+                    write(mOut, std::uint32_t(mObj.size()));
+                    for(const auto& v : mObj) encode(mOut, v);
+                    break;
+                case Json::objectValue:
+                    write(mOut, std::uint32_t(mObj.size()));
+                    for(const auto& k : mObj.getMemberNames())
+                    {
+                        writeStr(mOut, k);
+                        encode(mOut, mObj[k]);
+                    }
+                    break;
+            }
+        }
+
+        // Bounds-checked reader over a cache region; throws on truncated or
+        // corrupted data.
+        struct CacheReader
+        {
+            const char* ptr;
+            const char* end;
+
+            template <typename T>
+            T read()
+            {
+                if(SizeT(end - ptr) < sizeof(T))
+                    throw runtime_error("truncated asset cache");
+
+                T result;
+                memcpy(&result, ptr, sizeof(T));
+                ptr += sizeof(T);
+                return result;
+            }
+            string readStr()
+            {
+                auto size(read<std::uint32_t>());
+                if(SizeT(end - ptr) < size)
+                    throw runtime_error("truncated asset cache");
+
+                string result(ptr, size);
+                ptr += size;
+                return result;
+            }
+        };
+
+        ssvuj::Obj decode(CacheReader& mReader)
+        {
+            switch(mReader.read<std::uint8_t>())
+            {
+                case Json::nullValue: return {};
+                case Json::intValue:
+                    return ssvuj::Obj{mReader.read<Json::Int64>()};
+                case Json::uintValue:
+                    return ssvuj::Obj{mReader.read<Json::UInt64>()};
+                case Json::realValue:
+                    return ssvuj::Obj{mReader.read<double>()};
+                case Json::stringValue: return ssvuj::Obj{mReader.readStr()};
+                case Json::booleanValue:
+                    return ssvuj::Obj{mReader.read<std::uint8_t>() != 0};
+                case Json::arrayValue:
+                {
+                    ssvuj::Obj result{Json::arrayValue};
+                    auto size(mReader.read<std::uint32_t>());
+                    for(auto i(0u); i < size; ++i)
+                        result.append(decode(mReader));
+                    return result;
+                }
+                case Json::objectValue:
+                {
+                    ssvuj::Obj result{Json::objectValue};
+                    auto size(mReader.read<std::uint32_t>());
+                    for(auto i(0u); i < size; ++i)
+                    {
+                        auto key(mReader.readStr());
+                        result[key] = decode(mReader);
+                    }
+                    return result;
+                }
+            }
+
+            throw runtime_error("corrupted asset cache");
+        }
+    }
+
+    JsonCache::JsonCache(const Path& mCachePath) : cachePath{mCachePath}
+    {
+        try
+        {
+            load();
+        }
+        catch(const runtime_error& mEx)
+        {
+            lo("hg::JsonCache") << "Ignoring " << cachePath.getStr() << ": "
+                                << mEx.what() << "\n";
+            entries.clear();
+        }
+    }
+
+    void JsonCache::load()
+    {
+        if(!file.open(cachePath.getStr())) return;
+
+        CacheReader reader{file.getData(), file.getData() + file.getSize()};
+        char magic[4];
+        for(auto& c : magic) c = reader.read<char>();
+        if(memcmp(magic, cacheMagic, sizeof(magic)) != 0 ||
+            reader.read<std::uint32_t>() != cacheVersion)
+            throw runtime_error("unknown format");
+
+        auto count(reader.read<std::uint32_t>());
+        for(auto i(0u); i < count; ++i)
+        {
+            auto path(reader.readStr());
+            Entry e;
+            e.mtime = reader.read<std::int64_t>();
+            e.size = reader.read<std::uint64_t>();
+            e.dataSize = reader.read<std::uint32_t>();
+            if(SizeT(reader.end - reader.ptr) < e.dataSize)
+                throw runtime_error("truncated asset cache");
+
+            e.data = reader.ptr;
+            reader.ptr += e.dataSize;
+            entries.emplace(move(path), e);
+        }
+    }
+    ssvuj::Obj JsonCache::getFromFile(const Path& mPath)
+    {
+        std::uint64_t parsedBytes{0};
+        return getFromFile(mPath, parsedBytes);
+    }
+    ssvuj::Obj JsonCache::getFromFile(
+        const Path& mPath, std::uint64_t& mParsedBytes)
+    {
+        const auto& key(mPath.getStr());
+        std::int64_t mtime;
+        std::uint64_t size;
+        if(!VFS::getFileStamp(mPath, mtime, size))
+            return VFS::getJson(mPath);
+
+        auto itr(entries.find(key));
+        if(itr != end(entries) && itr->second.mtime == mtime &&
+            itr->second.size == size)
+        {
+            try
+            {
+                CacheReader reader{
+                    itr->second.data, itr->second.data + itr->second.dataSize};
+                auto result(decode(reader));
+
+                lock_guard<std::mutex> lock{mutex};
+                usedEntries.emplace(key);
+                return result;
+            }
+            catch(const runtime_error&)
+            {
+                // Fall through and reparse the file.
+            }
+        }
+
+        auto result(VFS::getJson(mPath));
+        mParsedBytes += size;
+        NewEntry e{mtime, size, {}};
+        encode(e.data, result);
+
+        lock_guard<std::mutex> lock{mutex};
+        newEntries[key] = move(e);
+        dirty = true;
+        return result;
+    }
+
+    void JsonCache::save()
+    {
+        lock_guard<std::mutex> lock{mutex};
+
+        // Entries not used by this process, e.g. music data skipped by the
+        // server, are kept as long as their files are unchanged.
+        vector<const string*> keptKeys;
+        bool stale{false};
+        for(const auto& p : entries)
+        {
+            if(newEntries.count(p.first) > 0) continue;
+
+            std::int64_t mtime;
+            std::uint64_t size;
+            if(usedEntries.count(p.first) > 0 ||
+                (VFS::getFileStamp(Path{p.first}, mtime, size) &&
+                    mtime == p.second.mtime && size == p.second.size))
+                keptKeys.emplace_back(&p.first);
+            else
+                stale = true;
+        }
+        if(!dirty && !stale) return;
+
+        string out;
+        out.append(cacheMagic, sizeof(cacheMagic));
+        write(out, cacheVersion);
+        write(out, std::uint32_t(keptKeys.size() + newEntries.size()));
+
+        auto writeEntry([&out](const string& mPath, std::int64_t mMtime,
+            std::uint64_t mSize, const char* mData, SizeT mDataSize)
+            {
+                writeStr(out, mPath);
+                write(out, mMtime);
+                write(out, mSize);
+                write(out, std::uint32_t(mDataSize));
+                out.append(mData, mDataSize);
+            });
+
+        for(const auto& k : keptKeys)
+        {
+            const auto& e(entries.at(*k));
+            writeEntry(*k, e.mtime, e.size, e.data, e.dataSize);
+        }
+        for(const auto& p : newEntries)
+            writeEntry(p.first, p.second.mtime, p.second.size,
+                p.second.data.data(), p.second.data.size());
+
+        // `entries` points into the mapped file: release it before
+        // overwriting the file.
+        entries.clear();
+        usedEntries.clear();
+        newEntries.clear();
+        file.close();
+        dirty = false;
+
+        string tempPath{cachePath.getStr() + ".tmp"};
+        {
+            ofstream tempFile{tempPath, ios::binary | ios::trunc};
+            tempFile.write(out.data(), out.size());
+            if(!tempFile)
+            {
+                lo("hg::JsonCache") << "Could not write " << tempPath << "\n";
+                return;
+            }
+        }
+        if(!Utils::replaceFile(tempPath, cachePath.getStr()))
+            lo("hg::JsonCache")
+                << "Could not replace " << cachePath.getStr() << "\n";
+    }
+}
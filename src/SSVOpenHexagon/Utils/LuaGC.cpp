@@ -0,0 +1,70 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/LuaGC.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+
+namespace hg
+{
+    namespace
+    {
+        // Lua 5.1 and LuaJIT restart the collector after an explicit
+        // step or collection, so both stop it again.
+        constexpr const char* gcPrelude{R"(
+local hg_gcLastKB = 0
+function hg_gcCollect()
+    collectgarbage("collect")
+    collectgarbage("stop")
+    hg_gcLastKB = collectgarbage("count")
+    return hg_gcLastKB
+end
+function hg_gcStep(mMinKB)
+    local before = collectgarbage("count")
+    local debt = before - hg_gcLastKB
+    if debt < mMinKB then debt = mMinKB end
+    collectgarbage("step", debt)
+    collectgarbage("stop")
+    hg_gcLastKB = collectgarbage("count")
+    return before
+end
+collectgarbage("stop")
+)"};
+    }
+
+    void LuaGC::attach(Lua::LuaContext& mLua)
+    {
+        lua = &mLua;
+        currentKB = peakKB = 0.f;
+
+        istringstream s{gcPrelude};
+        try
+        {
+            mLua.executeCode(s);
+        }
+        catch(runtime_error& mError)
+        {
+            // The automatic collector is still running in this case.
+            ssvu::lo("hg::LuaGC") << mError.what() << "\n";
+            lua = nullptr;
+        }
+    }
+
+    void LuaGC::collect()
+    {
+        if(lua == nullptr) return;
+
+        currentKB = Utils::runLuaFunction<float>(*lua, "hg_gcCollect");
+        peakKB = max(peakKB, currentKB);
+    }
+
+    void LuaGC::step(float mMinKB)
+    {
+        if(lua == nullptr) return;
+
+        currentKB = Utils::runLuaFunction<float>(*lua, "hg_gcStep", mMinKB);
+        peakKB = max(peakKB, currentKB);
+    }
+}
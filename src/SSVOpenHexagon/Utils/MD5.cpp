@@ -0,0 +1,137 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstring>
+#include "SSVOpenHexagon/Utils/MD5.hpp"
+
+using namespace std;
+
+namespace hg
+{
+    namespace
+    {
+        constexpr std::uint32_t sines[64]{0xd76aa478, 0xe8c7b756, 0x242070db,
+            0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122,
+            0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+            0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681,
+            0xe7d3fbc8, 0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+            0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a, 0xfffa3942,
+            0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9,
+            0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa, 0xd4ef3085,
+            0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3,
+            0x8f0ccc92, 0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0,
+            0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb,
+            0xeb86d391};
+
+        constexpr unsigned int shifts[64]{7, 12, 17, 22, 7, 12, 17, 22, 7,
+            12, 17, 22, 7, 12, 17, 22, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14,
+            20, 5, 9, 14, 20, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4,
+            11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10,
+            15, 21};
+
+        inline std::uint32_t rotl(std::uint32_t mX, unsigned int mN) noexcept
+        {
+            return (mX << mN) | (mX >> (32 - mN));
+        }
+    }
+
+    MD5::MD5() : state{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476} {}
+
+    void MD5::transform(const unsigned char* mBlock)
+    {
+        std::uint32_t m[16];
+        for(auto i(0u); i < 16; ++i)
+            m[i] = std::uint32_t(mBlock[i * 4]) |
+                   std::uint32_t(mBlock[i * 4 + 1]) << 8 |
+                   std::uint32_t(mBlock[i * 4 + 2]) << 16 |
+                   std::uint32_t(mBlock[i * 4 + 3]) << 24;
+
+        auto a(state[0]), b(state[1]), c(state[2]), d(state[3]);
+        for(auto i(0u); i < 64; ++i)
+        {
+            std::uint32_t f;
+            unsigned int g;
+
+            if(i < 16)
+            {
+                f = (b & c) | (~b & d);
+                g = i;
+            }
+            else if(i < 32)
+            {
+                f = (d & b) | (~d & c);
+                g = (5 * i + 1) % 16;
+            }
+            else if(i < 48)
+            {
+                f = b ^ c ^ d;
+                g = (3 * i + 5) % 16;
+            }
+            else
+            {
+                f = c ^ (b | ~d);
+                g = (7 * i) % 16;
+            }
+
+            auto temp(d);
+            d = c;
+            c = b;
+            b += rotl(a + f + sines[i] + m[g], shifts[i]);
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+
+    void MD5::update(const char* mData, SizeT mSize)
+    {
+        auto data(reinterpret_cast<const unsigned char*>(mData));
+        auto used(SizeT(byteCount % 64));
+        byteCount += mSize;
+
+        if(used > 0)
+        {
+            auto toCopy(min(mSize, 64 - used));
+            memcpy(block + used, data, toCopy);
+            data += toCopy;
+            mSize -= toCopy;
+            if(used + toCopy < 64) return;
+
+            transform(block);
+        }
+
+        for(; mSize >= 64; data += 64, mSize -= 64) transform(data);
+        memcpy(block, data, mSize);
+    }
+
+    string MD5::getHexDigest()
+    {
+        auto bitCount(byteCount * 8);
+
+        unsigned char padding[72]{0x80};
+        auto used(SizeT(byteCount % 64));
+        auto padSize(used < 56 ? 56 - used : 120 - used);
+        for(auto i(0u); i < 8; ++i)
+            padding[padSize + i] = (bitCount >> (i * 8)) & 0xff;
+        update(reinterpret_cast<const char*>(padding), padSize + 8);
+
+        constexpr const char* hexDigits{"0123456789abcdef"};
+        string result;
+        result.reserve(32);
+        for(auto s : state)
+            for(auto i(0u); i < 4; ++i)
+            {
+                auto byte((s >> (i * 8)) & 0xff);
+                result += hexDigits[byte >> 4];
+                result += hexDigits[byte & 0xf];
+            }
+
+        return result;
+    }
+}
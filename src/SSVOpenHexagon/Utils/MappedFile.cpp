@@ -0,0 +1,62 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <fstream>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "SSVOpenHexagon/Utils/MappedFile.hpp"
+
+using namespace std;
+
+namespace hg
+{
+    bool MappedFile::open(const string& mPath)
+    {
+        close();
+
+#ifndef _WIN32
+        int fd{::open(mPath.c_str(), O_RDONLY)};
+        if(fd == -1) return false;
+
+        struct stat s;
+        if(fstat(fd, &s) == 0 && s.st_size > 0)
+        {
+            auto addr(
+                mmap(nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+            if(addr != MAP_FAILED)
+            {
+                data = static_cast<const char*>(addr);
+                size = s.st_size;
+            }
+        }
+        ::close(fd);
+#else
+        ifstream file{mPath, ios::binary};
+        if(!file) return false;
+
+        buffer.assign(
+            istreambuf_iterator<char>{file}, istreambuf_iterator<char>{});
+        if(!buffer.empty())
+        {
+            data = buffer.data();
+            size = buffer.size();
+        }
+#endif
+
+        return data != nullptr;
+    }
+    void MappedFile::close()
+    {
+#ifndef _WIN32
+        if(data != nullptr) munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+        buffer.clear();
+    }
+}
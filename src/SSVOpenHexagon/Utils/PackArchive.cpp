@@ -0,0 +1,147 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <cstring>
+#include <fstream>
+#include "SSVOpenHexagon/Utils/PackArchive.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+using namespace ssvu;
+using namespace ssvu::FileSystem;
+
+namespace hg
+{
+    namespace
+    {
+        constexpr char archiveMagic[4]{'O', 'H', 'P', 'K'};
+        constexpr std::uint32_t archiveVersion{1};
+
+        template <typename T>
+        void write(ostream& mOut, const T& mValue)
+        {
+            mOut.write(reinterpret_cast<const char*>(&mValue), sizeof(T));
+        }
+
+        template <typename T>
+        T read(const char*& mPtr, const char* mEnd)
+        {
+            if(SizeT(mEnd - mPtr) < sizeof(T))
+                throw runtime_error("truncated pack archive");
+
+            T result;
+            memcpy(&result, mPtr, sizeof(T));
+            mPtr += sizeof(T);
+            return result;
+        }
+    }
+
+    PackArchive::PackArchive(const Path& mPath)
+    {
+        std::uint64_t archiveSize;
+        if(!Utils::getFileStamp(mPath, mtime, archiveSize) ||
+            !file.open(mPath.getStr()))
+            throw runtime_error("cannot read " + mPath.getStr());
+
+        const auto first(file.getData());
+        const auto end(first + file.getSize());
+        auto ptr(first);
+
+        char magic[4];
+        for(auto& c : magic) c = read<char>(ptr, end);
+        if(memcmp(magic, archiveMagic, sizeof(magic)) != 0 ||
+            read<std::uint32_t>(ptr, end) != archiveVersion)
+            throw runtime_error("unknown format");
+
+        auto count(read<std::uint32_t>(ptr, end));
+        for(auto i(0u); i < count; ++i)
+        {
+            auto nameSize(read<std::uint32_t>(ptr, end));
+            if(SizeT(end - ptr) < nameSize)
+                throw runtime_error("truncated pack archive");
+
+            string name(ptr, nameSize);
+            ptr += nameSize;
+
+            auto offset(read<std::uint64_t>(ptr, end));
+            auto dataSize(read<std::uint64_t>(ptr, end));
+            if(offset > file.getSize() || dataSize > file.getSize() - offset)
+                throw runtime_error("corrupted pack archive");
+
+            files.emplace(
+                move(name), FileView{first + offset, SizeT(dataSize)});
+        }
+    }
+
+    const FileView* PackArchive::find(const string& mName) const
+    {
+        auto itr(files.find(mName));
+        return itr == files.end() ? nullptr : &itr->second;
+    }
+    vector<string> PackArchive::getFileNames(const string& mPrefix) const
+    {
+        vector<string> result;
+        for(auto itr(files.lower_bound(mPrefix));
+            itr != files.end() && beginsWith(itr->first, mPrefix); ++itr)
+            result.emplace_back(itr->first);
+
+        return result;
+    }
+
+    void PackArchive::create(const Path& mFolder, const Path& mPath)
+    {
+        string root{mFolder.getStr()};
+        if(!endsWith(root, "/")) root += "/";
+
+        vector<string> names;
+        for(const auto& p : getScan<Mode::Recurse, Type::File>(root))
+            names.emplace_back(p.getStr().substr(root.size()));
+        sort(names);
+
+        std::uint64_t offset{sizeof(archiveMagic) + sizeof(archiveVersion) +
+                             sizeof(std::uint32_t)};
+        vector<std::uint64_t> sizes;
+        for(const auto& n : names)
+        {
+            std::int64_t fileMtime;
+            std::uint64_t fileSize;
+            if(!Utils::getFileStamp(Path{root + n}, fileMtime, fileSize))
+                throw runtime_error("cannot read " + root + n);
+
+            sizes.emplace_back(fileSize);
+            offset += sizeof(std::uint32_t) + n.size() +
+                      2 * sizeof(std::uint64_t);
+        }
+
+        // The index is written first, then every file is streamed after it.
+        string tempPath{mPath.getStr() + ".tmp"};
+        {
+            ofstream out{tempPath, ios::binary | ios::trunc};
+            out.write(archiveMagic, sizeof(archiveMagic));
+            write(out, archiveVersion);
+            write(out, std::uint32_t(names.size()));
+
+            for(auto i(0u); i < names.size(); ++i)
+            {
+                write(out, std::uint32_t(names[i].size()));
+                out.write(names[i].data(), names[i].size());
+                write(out, offset);
+                write(out, sizes[i]);
+                offset += sizes[i];
+            }
+            for(auto i(0u); i < names.size(); ++i)
+            {
+                // Streaming an empty buffer would set `out`'s failbit.
+                if(sizes[i] == 0) continue;
+
+                ifstream in{root + names[i], ios::binary};
+                out << in.rdbuf();
+            }
+
+            if(!out) throw runtime_error("cannot write " + tempPath);
+        }
+        if(!Utils::replaceFile(tempPath, mPath.getStr()))
+            throw runtime_error("cannot write " + mPath.getStr());
+    }
+}
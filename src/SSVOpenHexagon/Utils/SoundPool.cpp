@@ -0,0 +1,66 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/SoundPool.hpp"
+
+using namespace std;
+using namespace sf;
+
+namespace hg
+{
+    SoundPool::SoundPool(SizeT mVoiceCount) : voices(mVoiceCount) {}
+
+    bool SoundPool::isBusy(const Voice& mVoice)
+    {
+        return mVoice.sound.getStatus() != Sound::Stopped;
+    }
+    SoundPool::Voice* SoundPool::findVoice(const SoundBuffer& mBuffer)
+    {
+        for(auto& v : voices)
+            if(v.sound.getBuffer() == &mBuffer && isBusy(v)) return &v;
+
+        return nullptr;
+    }
+    SoundPool::Voice* SoundPool::findFreeVoice(Priority mPriority)
+    {
+        Voice* result{nullptr};
+
+        for(auto& v : voices)
+        {
+            if(!isBusy(v)) return &v;
+            if(v.priority > mPriority) continue;
+
+            if(result == nullptr || v.priority < result->priority ||
+                (v.priority == result->priority &&
+                    v.startedAt < result->startedAt))
+                result = &v;
+        }
+
+        return result;
+    }
+
+    void SoundPool::play(SoundBuffer& mBuffer, Mode mMode, Priority mPriority)
+    {
+        auto voice(findVoice(mBuffer));
+        if(voice != nullptr && mMode == Mode::Abort) return;
+        if(voice == nullptr) voice = findFreeVoice(mPriority);
+        if(voice == nullptr) return;
+
+        auto& sound(voice->sound);
+        sound.stop();
+        if(sound.getBuffer() != &mBuffer) sound.setBuffer(mBuffer);
+
+        voice->priority = mPriority;
+        voice->startedAt = ++playCount;
+        sound.play();
+    }
+    void SoundPool::stop()
+    {
+        for(auto& v : voices) v.sound.stop();
+    }
+    void SoundPool::setVolume(float mVolume)
+    {
+        for(auto& v : voices) v.sound.setVolume(mVolume);
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include <mutex>
+#include "SSVOpenHexagon/Utils/StartupReport.hpp"
+#include "SSVOpenHexagon/Utils/VFS.hpp"
+#include "SSVOpenHexagon/Global/Config.hpp"
+
+using namespace std;
+using namespace ssvuj;
+
+namespace hg
+{
+    namespace StartupReport
+    {
+        namespace
+        {
+            struct Record
+            {
+                float seconds{0.f};
+                std::uint64_t bytes{0};
+            };
+
+            struct Phase
+            {
+                Record total;
+                map<string, Record> packs;
+            };
+
+            std::mutex mutex;
+            map<string, Phase> phases;
+            vector<string> phaseOrder;
+
+            Obj toObj(const Record& mRecord)
+            {
+                Obj result;
+                result["seconds"] = mRecord.seconds;
+                result["bytes"] = Json::UInt64(mRecord.bytes);
+                return result;
+            }
+        }
+
+        void add(const string& mPhase, const string& mPack, float mSeconds,
+            std::uint64_t mBytes)
+        {
+            lock_guard<std::mutex> lock{mutex};
+
+            auto itr(phases.find(mPhase));
+            if(itr == end(phases))
+            {
+                phaseOrder.emplace_back(mPhase);
+                itr = phases.emplace(mPhase, Phase{}).first;
+            }
+
+            auto& phase(itr->second);
+            phase.total.seconds += mSeconds;
+            phase.total.bytes += mBytes;
+
+            if(mPack.empty()) return;
+            auto& pack(phase.packs[mPack]);
+            pack.seconds += mSeconds;
+            pack.bytes += mBytes;
+        }
+        void addBytes(
+            const string& mPhase, const string& mPack, std::uint64_t mBytes)
+        {
+            add(mPhase, mPack, 0.f, mBytes);
+        }
+
+        std::uint64_t getBytes(const vector<Path>& mFiles)
+        {
+            std::uint64_t result{0};
+            for(const auto& p : mFiles)
+            {
+                std::int64_t mtime;
+                std::uint64_t size;
+                if(VFS::getFileStamp(p, mtime, size)) result += size;
+            }
+
+            return result;
+        }
+
+        void save(const Path& mPath)
+        {
+            Obj root;
+            arch(root, "version", Config::getVersion());
+
+            {
+                lock_guard<std::mutex> lock{mutex};
+                for(const auto& name : phaseOrder)
+                {
+                    const auto& phase(phases.at(name));
+                    Obj obj{toObj(phase.total)};
+                    obj["name"] = name;
+                    for(const auto& p : phase.packs)
+                        obj["packs"][p.first] = toObj(p.second);
+
+                    root["phases"].append(obj);
+                }
+            }
+
+            writeToFile(root, mPath);
+        }
+    }
+}
@@ -4,6 +4,11 @@
 
 #include <dirent.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
 #include <fstream>
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 #include "SSVOpenHexagon/Global/Config.hpp"
@@ -131,34 +136,53 @@ namespace hg
             std::set<string>& mLuaScriptNames, const Path& mPackPath,
             const string& mLuaScript)
         {
-            for(const auto& name : getIncludedLuaFileNames(mLuaScript))
-            {
-                ssvufs::Path p{mPackPath + "/Scripts/" + name};
-
-                if(!p.exists<ssvufs::Type::File>())
+            recursiveFillIncludedLuaFileNames(mLuaScriptNames, mPackPath,
+                getIncludedLuaFileNames(mLuaScript), [](const Path& mPath)
                 {
-                    throw std::runtime_error(
-                        "\nCould not find script file:\n" + p.getStr() + "\n");
-                }
+                    return getIncludedLuaFileNames(VFS::getContents(mPath));
+                });
+        }
 
-                mLuaScriptNames.insert(name);
+        bool getFileStamp(
+            const Path& mPath, std::int64_t& mMtime, std::uint64_t& mSize)
+        {
+            struct stat s;
+            if(stat(mPath.getStr().c_str(), &s) != 0) return false;
 
-                try
-                {
-                    recursiveFillIncludedLuaFileNames(
-                        mLuaScriptNames, mPackPath, p.getContentsAsStr());
-                }
-                catch(const std::runtime_error& re)
-                {
-                    std::string s;
-                    s += re.what();
-                    s += "...from...";
-                    s += p.getStr();
-                    s += "\n";
+            mMtime = s.st_mtime;
+            mSize = s.st_size;
+            return true;
+        }
 
-                    throw std::runtime_error(s);
-                }
-            }
+        bool syncFile(const string& mPath)
+        {
+#ifndef _WIN32
+            int fd{::open(mPath.c_str(), O_RDONLY)};
+            if(fd == -1) return false;
+
+            bool result{fsync(fd) == 0};
+            ::close(fd);
+            return result;
+#else
+            return true;
+#endif
+        }
+
+        bool replaceFile(const string& mFrom, const string& mTo)
+        {
+#ifdef _WIN32
+            std::remove(mTo.c_str());
+            return std::rename(mFrom.c_str(), mTo.c_str()) == 0;
+#else
+            // The contents must reach the disk before the new name does,
+            // or a crash could leave `mTo` empty.
+            if(!syncFile(mFrom) || std::rename(mFrom.c_str(), mTo.c_str()))
+                return false;
+
+            auto slash(mTo.find_last_of('/'));
+            syncFile(slash == string::npos ? "." : mTo.substr(0, slash + 1));
+            return true;
+#endif
         }
 
         Color transformHue(const Color& in, float H)
@@ -0,0 +1,139 @@
+// Copyright (c) 2013-2015 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: http://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/VFS.hpp"
+#include "SSVOpenHexagon/Utils/Utils.hpp"
+
+using namespace std;
+using namespace ssvu;
+using namespace ssvu::FileSystem;
+
+namespace hg
+{
+    namespace VFS
+    {
+        namespace
+        {
+            vector<pair<string, UPtr<PackArchive>>> mounts;
+
+            // Finds the archive containing `mPath`, and the name of the
+            // file inside it. Repeated slashes, as produced by joining
+            // paths, are ignored.
+            const PackArchive* findArchive(const Path& mPath, string& mName)
+            {
+                const auto& str(mPath.getStr());
+
+                for(const auto& m : mounts)
+                {
+                    if(!beginsWith(str, m.first)) continue;
+
+                    mName.clear();
+                    for(auto i(m.first.size()); i < str.size(); ++i)
+                    {
+                        if(str[i] == '/' &&
+                            (mName.empty() || mName.back() == '/'))
+                            continue;
+
+                        mName += str[i];
+                    }
+
+                    return m.second.get();
+                }
+
+                return nullptr;
+            }
+        }
+
+        bool mount(const string& mMountPoint, const Path& mArchivePath)
+        {
+            try
+            {
+                mounts.emplace_back(
+                    mMountPoint, mkUPtr<PackArchive>(mArchivePath));
+                return true;
+            }
+            catch(const runtime_error& mEx)
+            {
+                lo("hg::VFS::mount") << "Cannot mount " << mArchivePath
+                                     << ": " << mEx.what() << "\n";
+            }
+
+            return false;
+        }
+
+        bool getView(const Path& mPath, FileView& mView)
+        {
+            string name;
+            auto archive(findArchive(mPath, name));
+            if(archive == nullptr) return false;
+
+            auto view(archive->find(name));
+            if(view == nullptr) return false;
+
+            mView = *view;
+            return true;
+        }
+
+        bool exists(const Path& mPath)
+        {
+            string name;
+            auto archive(findArchive(mPath, name));
+            if(archive == nullptr) return mPath.exists<Type::File>();
+
+            return archive->find(name) != nullptr;
+        }
+        string getContents(const Path& mPath)
+        {
+            string name;
+            auto archive(findArchive(mPath, name));
+            if(archive == nullptr) return mPath.getContentsAsStr();
+
+            auto view(archive->find(name));
+            if(view == nullptr) return "";
+
+            return {view->data, view->size};
+        }
+        ssvuj::Obj getJson(const Path& mPath)
+        {
+            FileView view;
+            if(!getView(mPath, view)) return ssvuj::getFromFile(mPath);
+
+            return ssvuj::getFromStr({view.data, view.size});
+        }
+
+        bool getFileStamp(
+            const Path& mPath, std::int64_t& mMtime, std::uint64_t& mSize)
+        {
+            string name;
+            auto archive(findArchive(mPath, name));
+            if(archive == nullptr)
+                return Utils::getFileStamp(mPath, mMtime, mSize);
+
+            auto view(archive->find(name));
+            if(view == nullptr) return false;
+
+            mMtime = archive->getMtime();
+            mSize = view->size;
+            return true;
+        }
+
+        vector<Path> getFilesRecursive(const Path& mFolder)
+        {
+            string prefix;
+            auto archive(findArchive(mFolder, prefix));
+            if(archive == nullptr)
+                return getScan<Mode::Recurse, Type::File>(mFolder);
+
+            string root{mFolder.getStr()};
+            if(!endsWith(root, "/")) root += "/";
+            if(!prefix.empty() && !endsWith(prefix, "/")) prefix += "/";
+
+            vector<Path> result;
+            for(const auto& n : archive->getFileNames(prefix))
+                result.emplace_back(root + n.substr(prefix.size()));
+
+            return result;
+        }
+    }
+}